@@ -2,15 +2,114 @@
 # coding: utf-8
 
 import itertools
+import ctypes
+import os
+from pathlib import Path
 from sage.all import *
 
+def load_star_precolor_library():
+    # libstar_precolor.so is built by make in src/ (or give its path in $STAR_PRECOLOR_LIBRARY);
+    # without it, check_precoloring_extension uses the Python search below.
+    path=os.environ.get("STAR_PRECOLOR_LIBRARY",Path(__file__).resolve().parent/"src"/"libstar_precolor.so")
+    try:
+        library=ctypes.CDLL(str(path))
+    except OSError:
+        return None
+    int_array=ctypes.POINTER(ctypes.c_int)
+    library.star_precolor_max_failures.restype=ctypes.c_int
+    library.star_precolor_max_failures.argtypes=[]
+    library.star_precolor_extend.restype=ctypes.c_int
+    library.star_precolor_extend.argtypes=[ctypes.c_int,int_array,ctypes.c_int,ctypes.c_int,ctypes.c_int,
+                                           int_array,ctypes.c_int,int_array,ctypes.c_int,
+                                           ctypes.c_int,ctypes.c_int,ctypes.c_int,ctypes.c_int,
+                                           ctypes.POINTER(ctypes.c_ulonglong),int_array]
+    return library
+
+star_precolor_library=load_star_precolor_library()
+
+def star_precolor_extend(G,num_precolored_verts,num_colors,recolor_verts=[],extend_verts=[],
+                         parallel_job_number=0,parallel_num_jobs=1,parallel_depth=0,num_threads=1):
+    # Runs the search of star_precolor on G in memory, with the vertices 0..n-1 of G in the order to color them.
+    # Returns a dict with num_precolorings (the precolorings that extend, with the colors up to renaming),
+    # num_failures, num_nodes, parallel_count, failures (the colors 0..num_colors-1 of vertices 0..num_precolored_verts-1
+    # of each failure) and completed (False if the search stopped after too many failures).
+    # As in star_precolor, the subtrees are split by the colorings of vertices 0..parallel_depth (one vertex deeper
+    # than in check_precoloring_extension, which splits on arrival at parallel_depth), and with num_threads>1,
+    # parallel_depth<num_precolored_verts is also where they are split between the threads.
+    if star_precolor_library is None:
+        raise RuntimeError("libstar_precolor.so not found; run make in src/")
+    n=G.num_verts()
+    edges=[x for u,v in G.edges(labels=False) for x in (u,v)]
+    max_failures=star_precolor_library.star_precolor_max_failures()
+    counts=(ctypes.c_ulonglong*4)()
+    failing_colors=(ctypes.c_int*(max_failures*num_precolored_verts))()
+    result=star_precolor_library.star_precolor_extend(
+        n,(ctypes.c_int*len(edges))(*edges),len(edges)//2,num_colors,num_precolored_verts,
+        (ctypes.c_int*len(recolor_verts))(*recolor_verts),len(recolor_verts),
+        (ctypes.c_int*len(extend_verts))(*extend_verts),len(extend_verts),
+        parallel_job_number,parallel_num_jobs,parallel_depth,num_threads,counts,failing_colors)
+    if result<0:
+        raise ValueError(f"star_precolor_extend: invalid arguments for n={n}, num_colors={num_colors}, "
+                         f"num_precolored_verts={num_precolored_verts}, parallel_depth={parallel_depth}, num_threads={num_threads}")
+    num_failures=min(counts[1],max_failures)
+    failures=[[failing_colors[i*num_precolored_verts+v]-1 for v in range(num_precolored_verts)] for i in range(num_failures)]
+    return {"num_precolorings":counts[0],"num_failures":counts[1],"num_nodes":counts[2],"parallel_count":counts[3],
+            "failures":failures,"completed":result==0}
+
+def star_precolor_extend_job(G,num_precolored_verts,num_colors,recolor_verts=[],extend_verts=[],
+                             parallel_job_number=0,parallel_num_jobs=1,parallel_depth=0,num_threads=1):
+    # Runs job parallel_job_number of star_precolor_extend, with the parallel_depth of check_precoloring_extension.
+    # The search below splits on the colorings of vertices 0..parallel_depth-1, which star_precolor calls parallel_depth-1.
+    # With parallel_depth=0, it never splits, so every job searches everything.
+    # With parallel_depth=1, vertex 0 has a single color, so job 1%parallel_num_jobs searches everything and the others
+    # nothing; star_precolor cannot split there, since it does not count the root at its parallel_depth=0.
+    if parallel_depth==0:
+        return star_precolor_extend(G,num_precolored_verts,num_colors,recolor_verts,extend_verts,0,1,0,num_threads)
+    if parallel_depth==1:
+        if parallel_job_number!=1%parallel_num_jobs:
+            return {"num_precolorings":0,"num_failures":0,"num_nodes":0,"parallel_count":1,"failures":[],"completed":True}
+        return star_precolor_extend(G,num_precolored_verts,num_colors,recolor_verts,extend_verts,0,1,0,num_threads)
+    return star_precolor_extend(G,num_precolored_verts,num_colors,recolor_verts,extend_verts,
+                                parallel_job_number,parallel_num_jobs,parallel_depth-1,num_threads)
+
+def check_parallel_split(G,num_precolored_verts,num_colors,recolor_verts=[],extend_verts=[],parallel_num_jobs=3):
+    # Checks that at each parallel_depth of check_precoloring_extension, the jobs of a split add up to the whole search:
+    # their num_precolorings and num_failures sum to those of a single job, and their failures are those of a single job.
+    # The searches must not stop at the cap on the failures.
+    whole=star_precolor_extend(G,num_precolored_verts,num_colors,recolor_verts,extend_verts)
+    assert whole["completed"]
+    for parallel_depth in range(num_precolored_verts+1):
+        jobs=[star_precolor_extend_job(G,num_precolored_verts,num_colors,recolor_verts,extend_verts,
+                                       job,parallel_num_jobs,parallel_depth)
+              for job in range(parallel_num_jobs)]
+        if parallel_depth==0:
+            jobs=jobs[:1]  # every job searches everything
+        assert all(result["completed"] for result in jobs)
+        assert sum(result["num_precolorings"] for result in jobs)==whole["num_precolorings"], parallel_depth
+        assert sum(result["num_failures"] for result in jobs)==whole["num_failures"], parallel_depth
+        assert sorted(c for result in jobs for c in result["failures"])==sorted(whole["failures"]), parallel_depth
+    print(f"the jobs of a split add up to the whole search at every parallel_depth<={num_precolored_verts}")
+
 def check_precoloring_extension(G,num_precolored_verts,num_colors,precolor_verts=[],recolor_verts=[],extend_verts=[],
-                                parallel_job_number=0,parallel_num_jobs=100,parallel_depth=3):
+                                parallel_job_number=0,parallel_num_jobs=100,parallel_depth=3,num_threads=1):
     # vertex coloring; we precolor vertices 0..num_precolored_verts-1, and then extend.
     # For parallelization: parallel_depth<=num_precolored_verts, 0<=parallel_job_number<parallel_num_jobs
     
     #print(num_precolored_verts, num_colors, precolor_verts, recolor_verts, extend_verts)
     
+    if star_precolor_library is not None:
+        # The search of star_precolor tries each precoloring once up to renaming the colors, so num_precolorings
+        # counts fewer precolorings than the search below, and only those that extend.
+        result=star_precolor_extend_job(G,num_precolored_verts,num_colors,recolor_verts,extend_verts,
+                                        parallel_job_number,parallel_num_jobs,parallel_depth,num_threads)
+        for i,c in enumerate(result["failures"]):
+            print("We found a failure! Current number of failures is:", i+1, "The coloring is", c)
+        if not result["completed"]:
+            print("Number of failures is over", result["num_failures"])
+            return False
+        print(f"num_precolorings={result['num_precolorings']}")
+        return True
+    
     # do some preprocessing for star vertex coloring
     PC=[[] for i in range(G.num_verts())]
     for S in itertools.combinations(G.vertices(),4):
@@ -126,3 +225,13 @@ if __name__=="__main__":
         parallel_job_number=1,parallel_num_jobs=2,parallel_depth=5,
         )
 
+    
+    if star_precolor_library is not None:
+        for parallel_num_jobs in [2,3,4]:
+            check_parallel_split(
+                G=Graph('IxKOgGDA_'),
+                num_precolored_verts=9,
+                num_colors=6,
+                extend_verts=[9],
+                parallel_num_jobs=parallel_num_jobs,
+                )
@@ -4,6 +4,7 @@
 #SBATCH --ntasks-per-node=1
 #SBATCH --partition=math-alderaan
 #SBATCH --nice=1000
+#SBATCH --requeue
 #SBATCH --job-name=star_chromatic_index
 #SBATCH --output=output-job.%A_%a-%j.txt
 
@@ -15,20 +16,23 @@ input="$1"
 base=$(basename "$input" .txt)
 depth="$2"
 modulus="$3"
+threads="$4"
+frontier="$5"  # optional frontier file from star_precolor --emit-frontier at this depth
 
 if [ "$depth" == "" ]
 then
   depth=4
 fi
 
-n="$(grep 'n=' "$input" | cut -c 3-)"
-
-app="$HOME/apps/StarChromaticIndex/git/StarChromaticIndex/src/star_precolor"
-if [ "$n" -gt 64 ]
+if [ "$threads" == "" ]
 then
-  app="${app}128"
+  # use the cores that SLURM gave us, e.g. with --cpus-per-task
+  threads=${SLURM_CPUS_PER_TASK:-1}
 fi
 
+# star_precolor chooses the width of its bit masks from n itself.
+app="$HOME/apps/StarChromaticIndex/git/StarChromaticIndex/src/star_precolor"
+
 cluster="$(hostname -s | cut -c 6-10)"
 if [ "$cluster" == "alder" ]; then
   # do nothing
@@ -56,18 +60,54 @@ fi
 
 output_file="$output_dir/output_${base}-${modulus}-job${jobnumpadded}.txt"
 
-header="Processing base=$base into $output_dir with $numjobs total jobs; depth=$depth, modulus=$modulus; this is job $jobnum on machine $(hostname -s)"
+# If we were preempted or hit the walltime, star_precolor saved its search here on SIGTERM,
+# so a requeued job continues where it stopped and appends to the same output file.
+# A checkpoint only resumes with the number of threads that wrote it, which is in its name,
+# so a requeued job that got a different number of cores still uses the threads of its checkpoint.
+checkpoint_prefix="$output_dir/checkpoint_${base}-${modulus}-job${jobnumpadded}"
+resume=""
+for saved in "$checkpoint_prefix"-threads*.bin
+do
+  if [ -f "$saved" ]
+  then
+    saved_threads="${saved##*-threads}"
+    saved_threads="${saved_threads%.bin}"
+    if [ "$saved_threads" != "$threads" ]
+    then
+      echo "Resuming $saved with its $saved_threads threads instead of $threads"
+    fi
+    threads="$saved_threads"
+    resume="--resume"
+  fi
+done
+checkpoint_file="${checkpoint_prefix}-threads${threads}.bin"
+
+# With a frontier file, the prefixes are packed into $modulus ranges of about equal estimated cost,
+# and this job searches its range directly instead of walking the top of the tree.
+work_unit=""
+if [ "$frontier" != "" ]
+then
+  read first end cost <<< $("$app" --split-frontier "$frontier" $modulus | sed -n "$(($jobnum+1))p")
+  work_unit="--work-unit $frontier $first $end"
+fi
+
+header="Processing base=$base into $output_dir with $numjobs total jobs; depth=$depth, modulus=$modulus, threads=$threads, frontier=$frontier; this is job $jobnum on machine $(hostname -s)"
 jobinfo="JOB_NAME=${SLURM_JOB_NAME} JOB_ID=${SLURM_JOB_ID} ARRAY_JOB_ID=${SLURM_ARRAY_JOB_ID} TASK_ID=${SLURM_ARRAY_TASK_ID} TASK_MIN=${SLURM_ARRAY_TASK_MIN} TASK_MAX=${SLURM_ARRAY_TASK_MAX}"
 
 echo "$header"
 echo "$jobinfo"
 
-echo "$header" > "$output_file"
+if [ "$resume" == "" ]
+then
+  echo "$header" > "$output_file"
+else
+  echo "$header" >> "$output_file"
+fi
 echo "$jobinfo" >> "$output_file"
 date -Iseconds >> "$output_file"
 start=`date +%s`
 
-"$app" "$input" $jobnum $modulus $depth >> $output_file
+"$app" --threads $threads --checkpoint "$checkpoint_file" $resume $work_unit "$input" $jobnum $modulus $depth >> $output_file
 
 date -Iseconds >> $output_file
 finish=`date +%s`
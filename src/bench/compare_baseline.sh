@@ -0,0 +1,129 @@
+#!/bin/bash
+# Compares star_precolor with a baseline build of it on the whole instances (num_jobs=1) of bench.list.
+# The two builds may break the color symmetry differently, so their num_precolorings and num_failures differ,
+# but their results must agree, and so must their failures up to a renaming of the colors.
+# A failure is the "cur=" line of a precoloring that does not extend; we rename its colors in the order
+# they first appear, except on tendril leaves, whose colors 1 and 2 are the two kinds of leaf.
+# When only one build stops at the cap of 100 failures, its failures must be among those of the other.
+# Instances that the baseline cannot read (such as n=200 with 64-bit masks) are skipped.
+#
+# usage: ./compare_baseline.sh <star_precolor_baseline> <star_precolor>
+
+if [ "$2" == "" ]
+then
+  echo "usage: $0 <star_precolor_baseline> <star_precolor>"
+  exit 1
+fi
+
+baseline="$(readlink -f "$1")"
+app="$(readlink -f "$2")"
+
+cd "$(dirname "$0")"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# the result of an output: FAIL_CAPPED, FAIL, Done, or ERROR if the search did not finish
+result()
+{
+  if grep -q "^Number of failures is over" "$1"
+  then
+    echo FAIL_CAPPED
+  elif grep -q "^FAIL\." "$1"
+  then
+    echo FAIL
+  elif grep -q "^Done\." "$1"
+  then
+    echo Done
+  else
+    echo ERROR
+  fi
+}
+
+# the num_precolorings of the last line of an output
+num_precolorings()
+{
+  sed -n 's/^\(Done\|FAIL\)\. *num_precolorings= *\([0-9]*\).*/\2/p' "$1"
+}
+
+# the sorted failures of an output, with the colors renamed as above
+failures()
+{
+  awk '
+    FNR==NR {
+      if ($0 ~ /^L=/)
+        leaf[substr($0,3)+0]=1;
+      next;
+    }
+    /^cur=/ {
+      delete name;
+      count=0;
+      line="";
+      for (i=2; i<=NF; i++)
+      {
+        split($i,vc,":");
+        color=vc[2];
+        if (!(vc[1] in leaf))
+        {
+          if (!(color in name))
+            name[color]=++count;
+          color=name[color];
+        }
+        line=line " " vc[1] ":" color;
+      }
+      print line;
+    }' "$1" "$2" | sort -u
+}
+
+printf "%-28s %-11s %12s %8s  %-11s %12s %8s  %s\n" instance baseline num_precol failures star_precol num_precol failures comparison
+status=0
+while read file job num_jobs depth rest
+do
+  if [[ "$file" == "" || "$file" == \#* || "$num_jobs" != "1" ]]
+  then
+    continue
+  fi
+  "$baseline" "$file" $job $num_jobs $depth > "$work/baseline.txt"
+  "$app" "$file" $job $num_jobs $depth > "$work/app.txt"
+  got_baseline=$(result "$work/baseline.txt")
+  got_app=$(result "$work/app.txt")
+  failures "$file" "$work/baseline.txt" > "$work/baseline_failures.txt"
+  failures "$file" "$work/app.txt" > "$work/app_failures.txt"
+  only_baseline=$(comm -23 "$work/baseline_failures.txt" "$work/app_failures.txt" | wc -l)
+  only_app=$(comm -13 "$work/baseline_failures.txt" "$work/app_failures.txt" | wc -l)
+
+  if [ "$got_baseline" == "ERROR" ]
+  then
+    comparison="skipped, the baseline did not finish"
+  elif [ "${got_baseline%_CAPPED}" != "${got_app%_CAPPED}" ]
+  then
+    comparison="MISMATCH in the result"
+  elif [[ "$got_baseline" == "FAIL_CAPPED" && "$got_app" == "FAIL_CAPPED" ]]
+  then
+    comparison="same result, both capped"
+  elif [[ "$got_baseline" != "FAIL_CAPPED" && $only_app -gt 0 ]]
+  then
+    comparison="MISMATCH, $only_app failures not in the baseline"
+  elif [[ "$got_app" != "FAIL_CAPPED" && $only_baseline -gt 0 ]]
+  then
+    comparison="MISMATCH, $only_baseline baseline failures missing"
+  else
+    comparison="same result and failures"
+  fi
+  if [[ "$comparison" == MISMATCH* ]]
+  then
+    status=1
+  fi
+
+  printf "%-28s %-11s %12s %8s  %-11s %12s %8s  %s\n" "$file" \
+         "$got_baseline" "$(num_precolorings "$work/baseline.txt")" "$(grep -c "^cur=" "$work/baseline.txt")" \
+         "$got_app" "$(num_precolorings "$work/app.txt")" "$(grep -c "^cur=" "$work/app.txt")" \
+         "$comparison"
+done < bench.list
+
+if [ $status -eq 0 ]
+then
+  echo "compare_baseline: the results and failures agree with the baseline"
+else
+  echo "compare_baseline: MISMATCH with the baseline"
+fi
+exit $status
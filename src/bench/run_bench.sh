@@ -0,0 +1,92 @@
+#!/bin/bash
+# Runs the corpus of bench.list with star_precolor using 64-bit and 128-bit bit masks, and with star_precolor_oldgcc.
+# For each instance, we report the hits in the extension cache, the nodes and the extensions (precolorings that
+# extend or fail) per second, and we check that the result, num_precolorings and num_failures are the ones given in bench.list.
+# With repeats, each build runs the corpus that many times, and we report its fastest time for each instance.
+#
+# usage: ./run_bench.sh <star_precolor> <star_precolor_oldgcc> [repeats]
+
+if [ "$2" == "" ]
+then
+  echo "usage: $0 <star_precolor> <star_precolor_oldgcc> [repeats]"
+  exit 1
+fi
+
+app="$(readlink -f "$1")"
+app_oldgcc="$(readlink -f "$2")"
+repeats="${3:-1}"
+
+cd "$(dirname "$0")"
+output=$(mktemp)
+trap 'rm -f "$output"' EXIT
+
+# label and command line of each build; the instances with n>64 use wider bit masks anyway
+builds=("64-bit|$app --mask-bits 64" "128-bit|$app --mask-bits 128" "oldgcc|$app_oldgcc")
+
+printf "%-8s %-36s %-11s %12s %8s %12s %12s %8s %12s %12s\n" build instance result num_precol failures nodes cache_hits seconds nodes/sec ext/sec
+status=0
+for build in "${builds[@]}"
+do
+  label="${build%%|*}"
+  command="${build#*|}"
+  : > "$output"
+  start=$(date +%s%N)
+  for ((r=0; r<repeats; r++))
+  do
+    $command --batch bench.list >> "$output"
+  done
+  finish=$(date +%s%N)
+
+  # the instances are numbered in the order of bench.list, and their records are in the order of completion
+  awk -v label="$label" -v wall=$(( (finish-start)/1000000 )) -v repeats=$repeats '
+    BEGIN { count=0; }
+    FILENAME=="bench.list" {
+      if ($0 ~ /^[ \t]*(#|$)/)
+        next;
+      split($0,expected,"#");
+      name[count]=$1 " " $2 "/" $3 "@" $4;
+      want[count]=expected[2];
+      gsub(/^[ \t]+|[ \t]+$/,"",want[count]);
+      count++;
+      next;
+    }
+    /^instance=/ {
+      for (i=1; i<=NF; i++)
+      {
+        split($i,field,"=");
+        value[field[1]]=field[2];
+      }
+      k=value["instance"];
+      got[k]=value["result"] " " value["num_precolorings"] " " value["num_failures"];
+      if (!(k in best) || (value["seconds"]+0<best[k]))
+        best[k]=value["seconds"]+0;
+      nodes[k]=value["nodes"];
+      cache_hits[k]=value["cache_hits"];
+      extensions[k]=value["num_precolorings"]+value["num_failures"];
+      runs[k]++;
+    }
+    END {
+      mismatches=0;
+      for (k=0; k<count; k++)
+      {
+        split(got[k],g," ");
+        rate_nodes=(best[k]>0) ? sprintf("%12.0f",nodes[k]/best[k]) : sprintf("%12s","-");
+        rate_extensions=(best[k]>0) ? sprintf("%12.0f",extensions[k]/best[k]) : sprintf("%12s","-");
+        ok=(runs[k]==repeats) && (got[k]==want[k]);
+        printf "%-8s %-36s %-11s %12s %8s %12s %12s %8.3f %s %s%s\n",label,name[k],g[1],g[2],g[3],nodes[k],cache_hits[k],best[k],
+               rate_nodes,rate_extensions,ok ? "" : "  MISMATCH, expected " want[k];
+        if (!ok)
+          mismatches++;
+      }
+      printf "%-8s wall time %.3f seconds for %d run(s) of the corpus, %d mismatches\n\n",label,wall/1000.0,repeats,mismatches;
+      exit (mismatches>0);
+    }' bench.list "$output" || status=1
+done
+
+if [ $status -eq 0 ]
+then
+  echo "bench: all results match bench.list"
+else
+  echo "bench: MISMATCH in the results"
+fi
+exit $status
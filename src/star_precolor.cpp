@@ -4,16 +4,182 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <iostream>  // std::cin, for graph6 input
 #include <cstdio>
+#include <cstdint>
+#include <cassert>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <unistd.h>  // fsync
+#include <fcntl.h>
+#include <sys/mman.h>  // mmap, for binary instance files
+#include <sys/stat.h>
+#include <random>
+#include <cmath>
 
 
-#ifdef USE128BITS
-    typedef unsigned __int128 BIT_MASK;  // 128-bits, should work with both gcc and Clang
+// Building with -DSEARCH_STATS=1 (make stats) keeps statistics of where the search spends its time,
+// which --stats writes to a JSON file; otherwise they are compiled out, and SEARCH_STAT(...) is empty.
+#ifndef SEARCH_STATS
+#define SEARCH_STATS 0
+#endif
+#if SEARCH_STATS
+#define SEARCH_STAT(...) __VA_ARGS__
 #else
-    typedef unsigned long long int BIT_MASK;  // we want a 64-bit unsigned integer for bit masks
+#define SEARCH_STAT(...)
+#endif
+
+// Building with -DSTAR_PRECOLOR_LIBRARY=1 (make libstar_precolor.so, part of make all) gives the shared library,
+// with star_precolor_extend below instead of main, for PrecoloringExtension.py.
+#ifndef STAR_PRECOLOR_LIBRARY
+#define STAR_PRECOLOR_LIBRARY 0
+#endif
+
+// A source file written by --codegen defines STAR_PRECOLOR_SPECIALIZED and includes this file (make specialized INSTANCE=...).
+// It has the instance as constants, and specialized_forbidden_colors(cur,c), which does the work of
+// compute_forbidden_colors for that instance with the adjacencies and blockers of each vertex unrolled.
+#ifndef STAR_PRECOLOR_SPECIALIZED
+#define STAR_PRECOLOR_SPECIALIZED 0
 #endif
 
 
+// The search is templated on the type BIT_MASK used for bit masks indexed by the vertices.
+// We use the narrowest type that holds n bits, since the wider types are slower:
+//   unsigned long long int for n<=64,
+//   unsigned __int128 for n<=128 (should work with both gcc and Clang),
+//   cWideBitMask<3> and cWideBitMask<4> for n<=192 and n<=256.
+
+
+template<int NUM_WORDS>
+class cWideBitMask
+// A fixed-size bit mask made of NUM_WORDS 64-bit words, for graphs with more than 128 vertices.
+// It supports the operations that the search uses on the built-in integer bit masks.
+{
+public:
+    unsigned long long int word[NUM_WORDS];  // word[0] holds bits 0..63
+    
+    cWideBitMask(unsigned long long int value=0)
+    {
+        word[0]=value;
+        for (int i=1; i<NUM_WORDS; i++)
+            word[i]=0;
+    }
+    
+    explicit operator bool() const
+    {
+        unsigned long long int any=0;
+        for (int i=0; i<NUM_WORDS; i++)
+            any|=word[i];
+        return any!=0;
+    }
+    
+    bool operator==(const cWideBitMask &other) const
+    {
+        for (int i=0; i<NUM_WORDS; i++)
+            if (word[i]!=other.word[i])
+                return false;
+        return true;
+    }
+    bool operator!=(const cWideBitMask &other) const { return !(*this==other); }
+    
+    cWideBitMask operator~() const
+    {
+        cWideBitMask result;
+        for (int i=0; i<NUM_WORDS; i++)
+            result.word[i]=~word[i];
+        return result;
+    }
+    
+    cWideBitMask &operator&=(const cWideBitMask &other) { for (int i=0; i<NUM_WORDS; i++) word[i]&=other.word[i]; return *this; }
+    cWideBitMask &operator|=(const cWideBitMask &other) { for (int i=0; i<NUM_WORDS; i++) word[i]|=other.word[i]; return *this; }
+    cWideBitMask &operator^=(const cWideBitMask &other) { for (int i=0; i<NUM_WORDS; i++) word[i]^=other.word[i]; return *this; }
+    
+    cWideBitMask &operator<<=(int shift)
+    {
+        const int words=shift/64, bits=shift%64;
+        for (int i=NUM_WORDS-1; i>=0; i--)
+        {
+            unsigned long long int value=0;
+            if (i-words>=0)
+            {
+                value=word[i-words]<<bits;
+                if ((bits>0) && (i-words-1>=0))
+                    value|=word[i-words-1]>>(64-bits);
+            }
+            word[i]=value;
+        }
+        return *this;
+    }
+    
+    cWideBitMask &operator>>=(int shift)
+    {
+        const int words=shift/64, bits=shift%64;
+        for (int i=0; i<NUM_WORDS; i++)
+        {
+            unsigned long long int value=0;
+            if (i+words<NUM_WORDS)
+            {
+                value=word[i+words]>>bits;
+                if ((bits>0) && (i+words+1<NUM_WORDS))
+                    value|=word[i+words+1]<<(64-bits);
+            }
+            word[i]=value;
+        }
+        return *this;
+    }
+    
+    friend cWideBitMask operator&(cWideBitMask a,const cWideBitMask &b) { return a&=b; }
+    friend cWideBitMask operator|(cWideBitMask a,const cWideBitMask &b) { return a|=b; }
+    friend cWideBitMask operator^(cWideBitMask a,const cWideBitMask &b) { return a^=b; }
+    friend cWideBitMask operator<<(cWideBitMask a,int shift) { return a<<=shift; }
+    friend cWideBitMask operator>>(cWideBitMask a,int shift) { return a>>=shift; }
+};
+
+
+template<typename BIT_MASK>
+BIT_MASK first_bits_mask(int k)
+    // mask with the first k positions set.
+    // Note that when k is equal to the number of bits in BIT_MASK, then 1<<k is not the desired 0,
+    // so we set the bits one at a time; this is only done when setting up a search.
+{
+    BIT_MASK mask=0;
+    for (int i=0; (i<k) && (i<(int)(8*sizeof(BIT_MASK))); i++)
+        mask|=((BIT_MASK)1)<<i;
+    return mask;
+}
+
+
+template<typename BIT_MASK>
+void mask_to_words(const BIT_MASK &mask,int num_words,uint64_t *words)
+    // the bits of mask as 64-bit words, word[0] holding bits 0..63, for binary instance files
+{
+    for (int w=0; w<num_words; w++)
+    {
+        words[w]=0;
+        for (int b=0; (b<64) && (64*w+b<(int)(8*sizeof(BIT_MASK))); b++)
+            if (mask&(((BIT_MASK)1)<<(64*w+b)))
+                words[w]|=1ull<<b;
+    }
+}
+
+
+template<typename BIT_MASK>
+BIT_MASK words_to_mask(const uint64_t *words,int num_words)
+{
+    BIT_MASK mask=0;
+    for (int w=0; w<num_words; w++)
+        for (int b=0; (b<64) && (64*w+b<(int)(8*sizeof(BIT_MASK))); b++)
+            if ((words[w]>>b)&1)
+                mask|=((BIT_MASK)1)<<(64*w+b);
+    return mask;
+}
+
+
 class cFourSetBlocker
 // helper class for testing for violations of the star chromatic condition.
 {
@@ -43,423 +209,3519 @@ public:
 };
 
 
-class cProblemInstance
+class cBlockerArena
+// All of the blockers packed into one contiguous block of memory, which is all that the innermost loop reads.
+// The four-set blockers of vertex v are at positions four_start[v]..four_start[v+1]-1 of the arrays
+// four_same(), four_other1(), four_other2(), and similarly for the three-set blockers.
 {
 public:
-    int n;  // number of vertices of the graph
-    std::vector<BIT_MASK> adj_pred_mask;  // bit mask of adjacent predecessors for each vertex
-    int num_colors;
-    int num_precolored_verts;
-    std::vector<std::vector<cFourSetBlocker> > FourSets;  // indexed by each vertex, gives the sets to check for the star chromatic condition on P4s and C4s.
-    std::vector<std::vector<cThreeSetBlocker> > ThreeSets;  // indexed by each vertex, gives the sets to check for the star chromatic condition from leaves of tendrils.
-    BIT_MASK tendril_leaves;  // bit array indicating which vertices are tendril leaves
-    std::vector<int> SymmetryPair;  // array where SymmetryPair[cur] is the lesser-indexed vertex in a symmetry pair
-    BIT_MASK symmetry_vertices;  // bit array indicating which vertices are the greater vertex in a symmetry pair
+    std::vector<int> four_start;  // offset table indexed by vertex, with n+1 entries
+    std::vector<int> three_start;  // offset table indexed by vertex, with n+1 entries
+    std::vector<uint8_t> storage;  // the arrays below, one after the other
     
-    // for parallelization
-    int parallel_job_number;
-    int parallel_num_jobs;
-    int parallel_depth;
-    
-    cProblemInstance(std::string file_input,
-                     int parallel_job_number,
-                     int parallel_num_jobs,
-                     int parallel_depth);
+    const uint8_t *four_same()    const { return &storage[0]; }
+    const uint8_t *four_other1()  const { return &storage[num_four]; }
+    const uint8_t *four_other2()  const { return &storage[2*num_four]; }
+    const uint8_t *three_leaf()   const { return &storage[3*num_four]; }
+    const uint8_t *three_other1() const { return &storage[3*num_four+num_three]; }
+    const uint8_t *three_other2() const { return &storage[3*num_four+2*num_three]; }
+    const uint8_t *three_type()   const { return &storage[3*num_four+3*num_three]; }
     
-    bool verify_precoloring_extension();
-};
-
-
-cProblemInstance::cProblemInstance(
-    std::string file_input,
-    int parallel_job_number,
-    int parallel_num_jobs,
-    int parallel_depth)
-    :  // initialization list
-    parallel_job_number{parallel_job_number},
-    parallel_num_jobs{parallel_num_jobs},
-    parallel_depth{parallel_depth}
-{
-    std::string line;
-    std::ifstream file_in(file_input);
-    if (file_in.is_open())
-        while (getline(file_in,line))
+    void build(const std::vector<std::vector<cFourSetBlocker> > &FourSets,
+               const std::vector<std::vector<cThreeSetBlocker> > &ThreeSets)
+    {
+        int n=FourSets.size();
+        four_start.assign(n+1,0);
+        three_start.assign(n+1,0);
+        for (int v=0; v<n; v++)
         {
-            //printf("line: %s\n",line.c_str());
-            
-            if (line.rfind("n=",0)==0)
-            {
-                n=std::stoi(line.substr(2));
-                adj_pred_mask.resize(n);  // initialize to be indexed by vertices
-                FourSets.resize(n);  // initialize to be indexed by vertices
-                ThreeSets.resize(n);  // initialize to be indexed by vertices
-                tendril_leaves=0;
-                SymmetryPair.resize(n);
-                symmetry_vertices=0;
-                printf("n=%d\n",n);
-                if (n>sizeof(BIT_MASK)*8)
-                {
-                    printf("ERROR: n=%d is larger than BIT_MASK (%d bits)\n",n,sizeof(BIT_MASK)*8);
-                    exit(99);
-                }
-            }
-            else if (line.rfind("num_colors=",0)==0)
-            {
-                num_colors=std::stoi(line.substr(11));
-                printf("num_colors=%d\n",num_colors);
-            }
-            else if (line.rfind("num_precolored_verts=",0)==0)
-            {
-                num_precolored_verts=std::stoi(line.substr(21));
-                printf("num_precolored_verts=%d\n",num_precolored_verts);
-            }
-            else if (line.rfind("G=",0)==0)
-            {
-                std::string mapping("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz@#");
-                // The first bit is the least significant bit.
-                
-                int pos=2;
-                int value=0;  // 6-bit value
-                int bits_left_in_value=0;
-                int count=0;
-                for (int j=0; j<n; ++j)
-                    for (int i=0; i<j; ++i)
-                    {
-                        if (bits_left_in_value==0)
-                        {
-                            // We read in the next character and decode it.
-                            value=mapping.find(line[pos]);
-                            //printf("Read in character at pos=%d, value=%d\n",pos,value);
-                            pos++;
-                            bits_left_in_value=6;
-                        }
-                        
-                        if ((value & 1)!=0)  // test whether the bottom bit is nonzero
-                        {
-                            // there is an edge between i and j.
-                            adj_pred_mask[j]|=((BIT_MASK)1)<<i;
-                            //printf("There is an edge between %2d and %2d\n",i,j);
-                        }
-                        
-                        value>>=1;
-                        bits_left_in_value--;
-                    }
-            }
-            else if (line.rfind("B=",0)==0)  // four-vertex set blocker
+            four_start [v+1]=four_start [v]+FourSets [v].size();
+            three_start[v+1]=three_start[v]+ThreeSets[v].size();
+        }
+        num_four =four_start [n];
+        num_three=three_start[n];
+        storage.assign(3*num_four+4*num_three+1,0);  // one extra byte, so that &storage[...] is valid even with no blockers
+        
+        uint8_t *arena=&storage[0];
+        for (int v=0; v<n; v++)
+        {
+            for (size_t j=0; j<FourSets[v].size(); j++)
             {
-                int same1,same2,other1,other2;
-                sscanf(line.substr(2).c_str(),
-                    "%d,%d,%d,%d",&same1,&same2,&other1,&other2);
-                // we assume same1>same2
-                FourSets[same1].push_back(cFourSetBlocker(same2,other1,other2));
-                //printf("There is a four-set blocker %d,%d and %d,%d\n",same1,same2,other1,other2);
+                int pos=four_start[v]+j;
+                arena[pos]           =FourSets[v][j].same;
+                arena[num_four+pos]  =FourSets[v][j].other1;
+                arena[2*num_four+pos]=FourSets[v][j].other2;
             }
-            else if (
-                        // three-vertex set blocker from tendril
-                     (line.rfind("T=",0)==0) ||
-                     (line.rfind("U=",0)==0) 
-                    )
+            for (size_t j=0; j<ThreeSets[v].size(); j++)
             {
-                int leaf,other1,other2,type;
-                type=(line.rfind("T=",0)==0) ? 2 : 1;
-                sscanf(line.substr(2).c_str(),
-                    "%d,%d,%d",&leaf,&other1,&other2);
-                // we assume other1>other2
-                if (leaf>other1)
-                    ThreeSets[leaf  ].push_back(cThreeSetBlocker(leaf,other1,other2,type));
-                else
-                    ThreeSets[other1].push_back(cThreeSetBlocker(leaf,other1,other2,type));
-                printf("There is a three-set blocker; leaf:%d other:%d and %d  type=%d\n",leaf,other1,other2,type);
+                int pos=3*num_four+three_start[v]+j;
+                arena[pos]            =ThreeSets[v][j].leaf;
+                arena[num_three+pos]  =ThreeSets[v][j].other1;
+                arena[2*num_three+pos]=ThreeSets[v][j].other2;
+                arena[3*num_three+pos]=ThreeSets[v][j].type;
             }
-            else if (line.rfind("L=",0)==0)  // tendril leaf
+        }
+    }
+    
+    bool matches(const std::vector<std::vector<cFourSetBlocker> > &FourSets,
+                 const std::vector<std::vector<cThreeSetBlocker> > &ThreeSets) const
+        // debug check that the arena holds exactly the blockers of FourSets and ThreeSets
+    {
+        for (size_t v=0; v<FourSets.size(); v++)
+        {
+            if ((four_start [v+1]-four_start [v]!=(int)FourSets [v].size()) ||
+                (three_start[v+1]-three_start[v]!=(int)ThreeSets[v].size()))
+                return false;
+            for (size_t j=0; j<FourSets[v].size(); j++)
             {
-                int leaf;
-                sscanf(line.substr(2).c_str(),
-                    "%d",&leaf);
-                //printf("tendril leaf %d\n",leaf);
-                tendril_leaves|=((BIT_MASK)1)<<leaf;
-                //printf("tendril_leaves=%lx\n",tendril_leaves);
-                if (leaf==0)
-                {
-                    printf("ERROR: cannot have vertex 0 be a leaf vertex\n");
-                    // Because we never allow vertex 0 to be any color other than 1, it cannot be a leaf vertex.
-                    exit(99);
-                }
+                int pos=four_start[v]+j;
+                if ((four_same()[pos]  !=FourSets[v][j].same) ||
+                    (four_other1()[pos]!=FourSets[v][j].other1) ||
+                    (four_other2()[pos]!=FourSets[v][j].other2))
+                    return false;
             }
-            else if (line.rfind("S=",0)==0)  // symmetry pair
+            for (size_t j=0; j<ThreeSets[v].size(); j++)
             {
-                int pair1,pair2;
-                sscanf(line.substr(2).c_str(),
-                    "%d,%d",&pair1,&pair2);
-                // we assume pair1<pair2
-                printf("symmetry pair %d,%d\n",pair1,pair2);
-                symmetry_vertices|=((BIT_MASK)1)<<pair2;
-                SymmetryPair[pair2]=pair1;
+                int pos=three_start[v]+j;
+                if ((three_leaf()[pos]  !=ThreeSets[v][j].leaf) ||
+                    (three_other1()[pos]!=ThreeSets[v][j].other1) ||
+                    (three_other2()[pos]!=ThreeSets[v][j].other2) ||
+                    (three_type()[pos]  !=ThreeSets[v][j].type))
+                    return false;
             }
         }
+        return true;
+    }
     
-    // no need to close the file, since the destructor automatically does this when the object goes out of scope.
-}
+    void assign(int n,const int32_t *four_offsets,const int32_t *three_offsets,const uint8_t *arena)
+        // takes the offset tables and the storage as they were saved in a binary instance file
+    {
+        four_start.assign(four_offsets,four_offsets+n+1);
+        three_start.assign(three_offsets,three_offsets+n+1);
+        num_four =four_start [n];
+        num_three=three_start[n];
+        storage.assign(arena,arena+3*num_four+4*num_three+1);
+    }
+
+private:
+    int num_four=0;  // total number of four-set blockers
+    int num_three=0;  // total number of three-set blockers
+};
 
 
-bool cProblemInstance::verify_precoloring_extension()
-    // should the parallelization parameters be parameters for this function?
+class cForbidRule
+// The colors that a constraint forbids on one of its vertices once its other vertices are colored:
+// if flag is 0, the color c[r] when c[p]==c[q], which covers adjacencies (with p==q==r) and four-set blockers;
+// otherwise the color c[r] when c[p] & flag, for the other vertices of a three-set blocker of type flag with leaf p.
+// On the leaf of a three-set blocker, leaf_colors are forbidden when c[p]==c[q].
 {
-    std::vector<int> c(n);  // assignment of colors; c[v] is the color assigned to vertex v.
-    std::vector<int> prev_c(n);  // keeping previous assignment of colors, for output
-    std::vector<BIT_MASK> color_mask(num_colors+1);  // bit mask of vertices with set color, for each color
-    int cur=1;  // current vertex
-    BIT_MASK cur_mask=2;  // a single bit set in the position corresponding to the current vertex, v
+public:
+    uint8_t p,q,r;
+    uint8_t flag;
+    unsigned int leaf_colors;
     
-    const BIT_MASK mask_extended_vertices=(((BIT_MASK)1)<<(num_precolored_verts-1))-1;
-            // a mask to clear the colors on vertices beyond the precolored vertices
-            // also clear bit num_verts_to_precolor-1
-    const BIT_MASK mask_first_n_bits=
-                (n==8*sizeof(BIT_MASK)) ?
-                ~(BIT_MASK)0 :
-                (((BIT_MASK)1)<<n)-1;
-            // mask with first n positions set; used to test with cur_mask when cur<n
-            // Note that when n is equal to the number of bits in BIT_MASK,
-            // then 1<<n will equal 1, instead of the desired 0.
-            // So we deal with that case separately.
-    const BIT_MASK mask_parallel_depth=((BIT_MASK)1)<<parallel_depth;
-            // mask with bit set at parallel_depth; used to test when cur==parallel_depth
+    unsigned int forbidden(const int *c) const
+    {
+        if (leaf_colors)
+            return (c[p]==c[q]) ? leaf_colors : 0;
+        if (flag)
+            return (c[p] & flag) ? 1u<<c[r] : 0;
+        return (c[p]==c[q]) ? 1u<<c[r] : 0;
+    }
+    
+    int kind() const
+        // 0 for an adjacency, 1 for a four-set blocker, and 2 for a three-set blocker
+    {
+        if (leaf_colors || flag)
+            return 2;
+        return (p==q) ? 0 : 1;
+    }
+};
+
+
+class cExtensionConstraint
+// An adjacency or a blocker with at least two extension vertices, for the extension solver.
+// Once all but one of its vertices are colored, rule[i] gives the colors that it forbids on vert[i].
+{
+public:
+    uint8_t num_verts;
+    uint8_t num_extension_verts;  // how many of the vertices are extension vertices
+    uint8_t vert[4];
+    cForbidRule rule[4];
+};
+
+
+class cSearchCounters
+// running totals of the search; each worker thread keeps its own, and they are merged at the end.
+{
+public:
+    unsigned long long int num_precolorings=0;  // note this only counts precolorings that extend
+    unsigned long long int num_nodes=0;  // number of times a vertex was given a color and the search advanced past it
+    int num_failures=0;
+    long long int parallel_count=0;  // counts the number of search tree nodes encountered at depth parallel_depth
+    unsigned long long int cache_lookups=0;  // precolorings looked up in the extension cache
+    unsigned long long int cache_hits=0;  // precolorings whose outcome was found in the extension cache
+    unsigned long long int nogoods_learned=0;  // nogoods learned from failures by the extension solver
+    unsigned long long int nogood_hits=0;  // precolorings found to be failures because they contain a nogood
     
+    void merge(const cSearchCounters &other)
+    {
+        num_precolorings+=other.num_precolorings;
+        num_nodes       +=other.num_nodes;
+        num_failures    +=other.num_failures;
+        parallel_count  +=other.parallel_count;
+        cache_lookups   +=other.cache_lookups;
+        cache_hits      +=other.cache_hits;
+        nogoods_learned +=other.nogoods_learned;
+        nogood_hits     +=other.nogood_hits;
+    }
+};
+
+
+class cSearchStats
+// Statistics of the searches of one worker thread, with SEARCH_STATS.
+// The depth of a node is the vertex that it colors, also for the extension solver, which colors them out of order.
+{
+public:
+    std::vector<unsigned long long int> nodes;  // nodes[v] counts the nodes at depth v
+    std::vector<unsigned long long int> backtracks;  // backtracks[v] counts the times that every color of v failed
+    unsigned long long int backjumps=0;  // backtracks of the extension solver past vertices that were not to blame
+    unsigned long long int rejected[3]={0,0,0};  // colors rejected by adjacencies, four-set blockers and three-set blockers
+    unsigned long long int extensions=0;  // precolorings that we extended, or found the outcome of otherwise
+    unsigned long long int extension_nodes_log2[65]={0};  // [k] counts the extensions with 2^(k-1)..2^k-1 nodes
+    double search_seconds=0;  // time in the search, including extensions
+    double extension_seconds=0;  // time in extensions
     
-    c[0]=1;  // only color to check for vertex 0
-    color_mask[1]|=((BIT_MASK)1)<<0;
-    cur=1;
-    cur_mask=2;
-    c[cur]=2;  // first color to check
+    bool in_extension=false;
+    unsigned long long int extension_start_nodes=0;
+    std::chrono::steady_clock::time_point extension_start_time;
     
-    unsigned long long int num_precolorings=0;
-    int num_failures=0;
+    void init(int n)
+    {
+        nodes.assign(n,0);
+        backtracks.assign(n,0);
+    }
     
-    long long int parallel_count=0;  // counts the number of search tree nodes encountered at depth parallel_depth
+    void begin_extension(unsigned long long int num_nodes)
+    {
+        in_extension=true;
+        extension_start_nodes=num_nodes;
+        extension_start_time=std::chrono::steady_clock::now();
+    }
     
-    bool backtrack;
+    void end_extension(unsigned long long int num_nodes)
+    {
+        if (!in_extension)
+            return;
+        in_extension=false;
+        extensions++;
+        const unsigned long long int extension_nodes=num_nodes-extension_start_nodes;
+        extension_nodes_log2[extension_nodes ? 64-__builtin_clzll(extension_nodes) : 0]++;
+        extension_seconds+=std::chrono::duration<double>(std::chrono::steady_clock::now()-extension_start_time).count();
+    }
     
-    while (true)  // main loop
+    void merge(const cSearchStats &other)
     {
-        // we have just arrived at cur, and we need to find the *next* valid color for cur
-        /*
-        printf("\nStarting main loop, cur=%2d c=%d\n",cur,c[cur]);
-        if (cur <= num_precolored_verts-12)
+        if (nodes.size()<other.nodes.size())
+            init(other.nodes.size());
+        for (size_t v=0; v<other.nodes.size(); v++)
         {
-            printf("cur=%2d num_precolorings=%19llu",cur,num_precolorings);
-            for (int i=0; i<=cur; i++)
-                printf(" %d:%d",i,c[i]);
-            printf("\n");
+            nodes[v]     +=other.nodes[v];
+            backtracks[v]+=other.backtracks[v];
         }
-        //*/
-        
-        
-        backtrack=true;
-        
-        while (c[cur])  // finding next color, this could be a valid color if it is positive
-            // Note that we might start the while loop where c[cur] is already 0, in which case we want to backtrack.
-            // We will use the colors 1..num_colors, and we count colors downward.
-        {
-            //printf("we have a candidate color for cur=%2d, c[cur]=%d\n",cur,c[cur]);
-            
-            // We test whether c[cur] is a valid color (ie, not on neighbors, star condition)
-            
-            if ((color_mask[c[cur]]&adj_pred_mask[cur])==0)  // we did not find this color c[cur] used in the neighborhood, so c[cur] is a valid color
-            {
-                // we now check the star coloring condition from four-vertex sets
-                int j;
-                for (j=FourSets[cur].size()-1; j>=0; j--)
-                    if ((c[cur]==c[FourSets[cur][j].same]) &&
-                        (c[FourSets[cur][j].other1]==c[FourSets[cur][j].other2]))
-                        //TODO: possible optimization: have FourSets[cur] be a local reference
-                        // c[cur] does not give a valid star coloring
-                        break;  // break out of this for loop, and then continue the while loop to find the next color
-                
-                //printf("done checking star condition, j=%2d\n",j);
-                if (j<0)
-                {
-                    // now need to check the three-vertex sets
-                    for (j=ThreeSets[cur].size()-1; j>=0; j--)
-                        if ((c[ThreeSets[cur][j].leaf] & ThreeSets[cur][j].type) &&
-                            (c[ThreeSets[cur][j].other1]==c[ThreeSets[cur][j].other2]))
-                            // c[cur] does not give a valid star coloring
-                        {
-                            /*
-                            if (ThreeSets[cur][j].type==1)
-                            printf("Violation of 3-sets: %d:%d %d:%d leaf %d:%d type %d\n",
-                                ThreeSets[cur][j].other1,c[ThreeSets[cur][j].other1],
-                                ThreeSets[cur][j].other2,c[ThreeSets[cur][j].other2],
-                                ThreeSets[cur][j].leaf,  c[ThreeSets[cur][j].leaf],
-                                ThreeSets[cur][j].type);
-                            //*/
-                            break;  // break out of this for loop, and then continue the while loop to find the next color
+        backjumps+=other.backjumps;
+        for (int k=0; k<3; k++)
+            rejected[k]+=other.rejected[k];
+        extensions+=other.extensions;
+        for (int k=0; k<65; k++)
+            extension_nodes_log2[k]+=other.extension_nodes_log2[k];
+        search_seconds   +=other.search_seconds;
+        extension_seconds+=other.extension_seconds;
+    }
+};
+
+
+class cSearchTimer
+// adds the time until it goes out of scope to seconds
+{
+public:
+    double &seconds;
+    std::chrono::steady_clock::time_point start;
+    
+    cSearchTimer(double &seconds) : seconds(seconds), start(std::chrono::steady_clock::now()) { }
+    ~cSearchTimer() { seconds+=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count(); }
+};
+
+
+class cSearchOptions
+// options for how the search is run; they do not change its results.
+{
+public:
+    int num_threads=1;  // number of worker threads splitting the subtrees below parallel_depth
+    long long int cache_entries=-1;  // bound on the number of entries of the extension caches of all worker threads;
+                                     // 0 disables the caches, and -1 chooses automatically
+    std::string checkpoint_file;  // where to save the state of the search; empty for no checkpoints
+    int checkpoint_interval=3600;  // seconds between checkpoints
+    bool resume=false;  // whether to continue the search from checkpoint_file
+    long long int estimate_probes=0;  // if positive, estimate the size of the search with this many random probes instead of searching
+    double job_hours=24;  // the length of a job when the estimate suggests the number of jobs
+    std::string emit_frontier_file;  // if not empty, write the prefixes at parallel_depth to this file instead of searching
+    int frontier_probes=0;  // random probes for each prefix, to estimate the cost of its subtree in the frontier file
+    std::string work_unit_file;  // if not empty, search only the prefixes work_unit_first..work_unit_end-1 of this frontier file
+    long long int work_unit_first=0,work_unit_end=0;
+    bool extension_solver=true;  // whether to extend the precolorings with the forward-checking solver, when it applies
+    int nogood_entries=64;  // bound on the number of nogoods that each worker thread keeps; 0 disables them
+    std::string stats_file;  // if not empty, write the statistics of the search to this JSON file, with SEARCH_STATS
+    bool quiet=false;  // print only errors, as in batch mode, where each instance gets a single result record
+};
+
+
+class cFrontierFile
+// A frontier file holds the colorings of the vertices 0..depth at which the search splits, in the order of the search,
+// and optionally an estimate of the cost of the subtree below each, so that the jobs can take ranges of equal cost.
+// The file is an 8-byte magic, the ints n, num_colors, num_precolored_verts, depth and has_costs,
+// the long long int num_prefixes, then depth+1 bytes for each prefix, and then a double for each prefix if has_costs.
+{
+public:
+    int n=0,num_colors=0,num_precolored_verts=0,depth=0,has_costs=0;
+    long long int num_prefixes=0;
+    
+    void write(const std::string &file_name,const std::vector<uint8_t> &prefixes,const std::vector<double> &costs)
+    {
+        num_prefixes=prefixes.size()/(depth+1);
+        has_costs=!costs.empty();
+        FILE *f=fopen(file_name.c_str(),"wb");
+        if (!f)
+        {
+            printf("ERROR: could not write frontier file %s\n",file_name.c_str());
+            exit(99);
+        }
+        const char magic[8]="SPFRNT1";
+        int header[5]={n,num_colors,num_precolored_verts,depth,has_costs};
+        fwrite(magic,1,8,f);
+        fwrite(header,sizeof(int),5,f);
+        fwrite(&num_prefixes,sizeof(num_prefixes),1,f);
+        fwrite(prefixes.data(),1,prefixes.size(),f);
+        if (has_costs)
+            fwrite(costs.data(),sizeof(double),costs.size(),f);
+        fclose(f);
+    }
+    
+    FILE *open(const std::string &file_name)
+        // reads the header, and leaves the file at the first prefix
+    {
+        FILE *f=fopen(file_name.c_str(),"rb");
+        char magic[8];
+        int header[5];
+        if (!f || (fread(magic,1,8,f)!=8) || (std::string(magic,7)!="SPFRNT1") ||
+            (fread(header,sizeof(int),5,f)!=5) || (fread(&num_prefixes,sizeof(num_prefixes),1,f)!=1))
+        {
+            printf("ERROR: could not read frontier file %s\n",file_name.c_str());
+            exit(99);
+        }
+        n=header[0];
+        num_colors=header[1];
+        num_precolored_verts=header[2];
+        depth=header[3];
+        has_costs=header[4];
+        return f;
+    }
+    
+    std::vector<uint8_t> read_prefixes(const std::string &file_name,long long int first,long long int end)
+        // the prefixes first..end-1, one after the other, with a byte for each color as in the file
+    {
+        FILE *f=open(file_name);
+        if ((first<0) || (first>end) || (end>num_prefixes))
+        {
+            printf("ERROR: the range %lld..%lld is not within the %lld prefixes of %s\n",first,end-1,num_prefixes,file_name.c_str());
+            exit(99);
+        }
+        std::vector<uint8_t> bytes((end-first)*(depth+1));
+        fseek(f,first*(depth+1),SEEK_CUR);
+        bool valid=(fread(bytes.data(),1,bytes.size(),f)==bytes.size());
+        fclose(f);
+        if (!valid)
+        {
+            printf("ERROR: frontier file %s is truncated\n",file_name.c_str());
+            exit(99);
+        }
+        return bytes;
+    }
+    
+    std::vector<double> read_costs(const std::string &file_name)
+        // the estimated costs of the prefixes, or 1 for each if the file has none
+    {
+        FILE *f=open(file_name);
+        std::vector<double> costs(num_prefixes,1.0);
+        bool valid=true;
+        if (has_costs)
+        {
+            fseek(f,num_prefixes*(depth+1),SEEK_CUR);
+            valid=(fread(costs.data(),sizeof(double),num_prefixes,f)==(size_t)num_prefixes);
+        }
+        fclose(f);
+        if (!valid)
+        {
+            printf("ERROR: frontier file %s is truncated\n",file_name.c_str());
+            exit(99);
+        }
+        return costs;
+    }
+};
+
+
+void split_frontier(const std::string &file_name,int num_tasks)
+    // Prints the ranges of prefixes "first end cost" of num_tasks tasks of about equal estimated cost, one task per line.
+{
+    cFrontierFile F;
+    std::vector<double> costs=F.read_costs(file_name);
+    double total=0;
+    for (double cost : costs)
+        total+=cost;
+    
+    long long int first=0;
+    double done=0;  // the cost of the prefixes before first
+    for (int task=0; task<num_tasks; task++)
+    {
+        // take prefixes until we reach the cost of the first task+1 tasks
+        long long int end=first;
+        double cost=0;
+        while ((end<F.num_prefixes) && ((task==num_tasks-1) || (done+cost+costs[end]/2<=total*(task+1)/num_tasks)))
+            cost+=costs[end++];
+        printf("%lld %lld %.6g\n",first,end,cost);
+        done+=cost;
+        first=end;
+    }
+}
+
+
+class cInstanceFile
+// A binary instance file holds an instance as the search uses it, so that loading it needs no parsing.
+// The file is an 8-byte magic and the ints n, num_colors, num_precolored_verts, num_words, num_four and num_three,
+// then num_words 64-bit words for adj_pred_mask of each vertex, for tendril_leaves and for symmetry_vertices,
+// the ints SymmetryPair[0..n-1], four_start[0..n] and three_start[0..n] of the blocker arena, and the bytes of its storage.
+// Each section starts at a multiple of 8 bytes and is in the byte order of the machine, so the file is read in place with mmap.
+{
+public:
+    int n=0,num_colors=0,num_precolored_verts=0,num_words=0,num_four=0,num_three=0;
+    const uint64_t *adj_pred_words=nullptr;  // num_words words for each vertex
+    const uint64_t *tendril_leaf_words=nullptr;
+    const uint64_t *symmetry_vertex_words=nullptr;
+    const int32_t *symmetry_pair=nullptr;
+    const int32_t *four_start=nullptr;
+    const int32_t *three_start=nullptr;
+    const uint8_t *storage=nullptr;
+    
+    static bool is_instance_file(const std::string &file_name)
+    {
+        char magic[8];
+        FILE *f=fopen(file_name.c_str(),"rb");
+        bool found=f && (fread(magic,1,8,f)==8) && (std::string(magic,7)=="SPINST1");
+        if (f)
+            fclose(f);
+        return found;
+    }
+    
+    void write(const std::string &file_name,const std::vector<uint64_t> &mask_words,const std::vector<int> &SymmetryPair,
+               const cBlockerArena &blockers)
+        // mask_words holds the words of adj_pred_mask of each vertex, then of tendril_leaves and then of symmetry_vertices
+    {
+        FILE *f=fopen(file_name.c_str(),"wb");
+        if (!f)
+        {
+            printf("ERROR: could not write instance file %s\n",file_name.c_str());
+            exit(99);
+        }
+        const char magic[8]="SPINST1";
+        int32_t header[6]={n,num_colors,num_precolored_verts,num_words,num_four,num_three};
+        fwrite(magic,1,8,f);
+        fwrite(header,sizeof(int32_t),6,f);
+        fwrite(mask_words.data(),sizeof(uint64_t),mask_words.size(),f);
+        write_padded(f,std::vector<int32_t>(SymmetryPair.begin(),SymmetryPair.end()));
+        write_padded(f,std::vector<int32_t>(blockers.four_start.begin(),blockers.four_start.end()));
+        write_padded(f,std::vector<int32_t>(blockers.three_start.begin(),blockers.three_start.end()));
+        fwrite(blockers.storage.data(),1,blockers.storage.size(),f);
+        if (fclose(f)!=0)
+        {
+            printf("ERROR: could not write instance file %s\n",file_name.c_str());
+            exit(99);
+        }
+    }
+    
+    void map(const std::string &file_name)
+        // maps the file into memory and points the sections into it
+    {
+        int fd=open(file_name.c_str(),O_RDONLY);
+        struct stat st;
+        if ((fd<0) || (fstat(fd,&st)!=0) ||
+            ((mapping=mmap(nullptr,st.st_size,PROT_READ,MAP_PRIVATE,fd,0))==MAP_FAILED))
+        {
+            printf("ERROR: could not read instance file %s\n",file_name.c_str());
+            exit(99);
+        }
+        close(fd);  // the mapping stays valid
+        mapping_size=st.st_size;
+        
+        const char *base=(const char *)mapping;
+        const int32_t *header=(const int32_t *)(base+8);
+        if ((mapping_size<32) || (std::string(base,7)!="SPINST1"))
+        {
+            printf("ERROR: %s is not an instance file\n",file_name.c_str());
+            exit(99);
+        }
+        n=header[0];
+        num_colors=header[1];
+        num_precolored_verts=header[2];
+        num_words=header[3];
+        num_four=header[4];
+        num_three=header[5];
+        
+        size_t pos=32;
+        adj_pred_words       =(const uint64_t *)(base+pos);  pos+=8*(size_t)n*num_words;
+        tendril_leaf_words   =(const uint64_t *)(base+pos);  pos+=8*(size_t)num_words;
+        symmetry_vertex_words=(const uint64_t *)(base+pos);  pos+=8*(size_t)num_words;
+        symmetry_pair        =(const int32_t *)(base+pos);   pos+=padded(4*(size_t)n);
+        four_start           =(const int32_t *)(base+pos);   pos+=padded(4*(size_t)(n+1));
+        three_start          =(const int32_t *)(base+pos);   pos+=padded(4*(size_t)(n+1));
+        storage              =(const uint8_t *)(base+pos);   pos+=3*(size_t)num_four+4*(size_t)num_three+1;
+        if ((n<1) || (num_words!=(n+63)/64) || (pos>mapping_size) ||
+            (four_start[n]!=num_four) || (three_start[n]!=num_three))
+        {
+            printf("ERROR: instance file %s is truncated or damaged\n",file_name.c_str());
+            exit(99);
+        }
+    }
+    
+    ~cInstanceFile()
+    {
+        if (mapping!=MAP_FAILED)
+            munmap(mapping,mapping_size);
+    }
+
+private:
+    void *mapping=MAP_FAILED;
+    size_t mapping_size=0;
+    
+    static size_t padded(size_t bytes) { return (bytes+7)/8*8; }
+    
+    static void write_padded(FILE *f,const std::vector<int32_t> &values)
+    {
+        const char zeros[8]={0};
+        size_t bytes=4*values.size();
+        fwrite(values.data(),1,bytes,f);
+        fwrite(zeros,1,padded(bytes)-bytes,f);
+    }
+};
+
+
+volatile std::sig_atomic_t stop_signal_received=0;  // set when the cluster preempts the job or it reaches its walltime
+
+void handle_stop_signal(int)
+{
+    stop_signal_received=1;
+}
+
+
+class cWorkerCheckpoint
+// the state of one worker thread in a checkpoint
+{
+public:
+    long long int next=0,end=0;  // the remaining tasks of the worker's queue
+    int root=-1;  // root of the search in progress, or -1 if there is none
+    int cur=0;  // the search continues by trying the colors c[cur] and below on cur
+    std::vector<int> c;  // colors of the vertices 0..cur
+};
+
+
+class cExtensionCache
+// Whether a precoloring extends depends only on the colors of the boundary vertices,
+// so we remember the outcome for the boundary colorings that we have already extended.
+// The key packs the (possibly canonicalized) colors of the boundary vertices, 5 bits per color.
+// The table is direct mapped, so a new key simply replaces the key in its slot; this bounds the memory.
+{
+public:
+    int key_words=0;  // number of 64-bit words in a key
+    size_t slot_mask=0;  // number of slots minus 1
+    std::vector<uint64_t> keys;  // key_words words for each slot
+    std::vector<uint8_t> outcome;  // 0 if the slot is empty, 1 if the precoloring is a failure, 2 if it extends
+    
+    void init(long long int max_entries,int num_key_words)
+    {
+        size_t num_slots=1;
+        while (2*num_slots<=(size_t)max_entries)
+            num_slots*=2;
+        key_words=num_key_words;
+        slot_mask=num_slots-1;
+        keys.assign(num_slots*key_words,0);
+        outcome.assign(num_slots,0);
+    }
+    
+    size_t slot(const uint64_t *key) const
+    {
+        uint64_t h=0;
+        for (int i=0; i<key_words; i++)
+            h=(h^key[i])*0x9e3779b97f4a7c15ull;
+        return (h^(h>>29))&slot_mask;
+    }
+    
+    int find(const uint64_t *key) const
+        // returns 1 if the key is known to extend, 0 if it is known to be a failure, and -1 if it is not in the table
+    {
+        size_t k=slot(key);
+        if (outcome[k]==0)
+            return -1;
+        for (int i=0; i<key_words; i++)
+            if (keys[k*key_words+i]!=key[i])
+                return -1;
+        return outcome[k]-1;
+    }
+    
+    void insert(const uint64_t *key,bool extends)
+    {
+        size_t k=slot(key);
+        for (int i=0; i<key_words; i++)
+            keys[k*key_words+i]=key[i];
+        outcome[k]=extends ? 2 : 1;
+    }
+};
+
+
+class cNogoodTable
+// A nogood is a coloring of some of the precolored vertices that does not extend, whatever the colors of the others;
+// the extension solver learns one from the conflict set of each failure.
+// A later precoloring that contains a nogood is a failure without any search.
+// The table is bounded, and a new nogood replaces the oldest one once it is full.
+{
+public:
+    int max_entries=0;
+    int next=0;  // the entry that the next nogood replaces, once the table is full
+    std::vector<std::vector<uint8_t> > entries;  // each as vertex, color, vertex, color, ...
+    
+    void init(int num_entries)
+    {
+        max_entries=num_entries;
+        next=0;
+        entries.clear();
+    }
+    
+    void insert(const std::vector<uint8_t> &nogood)
+    {
+        if ((int)entries.size()<max_entries)
+            entries.push_back(nogood);
+        else
+        {
+            entries[next]=nogood;
+            next=(next+1)%max_entries;
+        }
+    }
+    
+    bool contains(const int *c,bool rename_colors) const
+        // whether the coloring c contains a nogood; with rename_colors, also after renaming the colors of the nogood
+    {
+        for (const std::vector<uint8_t> &nogood : entries)
+        {
+            bool found=true;
+            if (rename_colors)
+            {
+                uint8_t rename[32]={0};
+                unsigned int used=0;  // the colors of c that some color of the nogood was renamed to
+                for (size_t i=0; (i<nogood.size()) && found; i+=2)
+                {
+                    const int color=c[nogood[i]];
+                    if (rename[nogood[i+1]]==0)
+                    {
+                        found=((used>>color)&1)==0;
+                        rename[nogood[i+1]]=color;
+                        used|=1u<<color;
+                    }
+                    else
+                        found=(rename[nogood[i+1]]==color);
+                }
+            }
+            else
+                for (size_t i=0; (i<nogood.size()) && found; i+=2)
+                    found=(c[nogood[i]]==nogood[i+1]);
+            if (found)
+                return true;
+        }
+        return false;
+    }
+};
+
+
+template<typename BIT_MASK>
+class cSearchState
+// the state of one backtracking search; each worker thread has its own.
+{
+public:
+    std::vector<int> c;  // assignment of colors; c[v] is the color assigned to vertex v.
+    std::vector<int> prev_c;  // keeping previous assignment of colors, for output
+    std::vector<int> max_color;  // max_color[v] is the largest color used on vertices 0..v, not counting tendril leaves
+    std::vector<BIT_MASK> color_mask;  // bit mask of vertices with set color, for each color
+    std::vector<unsigned int> forbidden_colors;  // bit k of forbidden_colors[v] is set if color k on v conflicts with the colors of v's predecessors
+    int root;  // vertices 0..root have fixed colors; the search is over when we backtrack to root
+    int cur;  // current vertex
+    BIT_MASK cur_mask;  // a single bit set in the position corresponding to the current vertex
+    int worker;  // the worker thread that owns this state
+    
+    cExtensionCache cache;
+    std::vector<uint64_t> cache_key;  // the key of the precoloring being extended
+    bool cache_pending;  // whether the outcome for cache_key should be inserted once it is known
+    
+    // for the extension solver
+    std::vector<unsigned int> domain;  // bit k of domain[v] is set if color k is still allowed on the extension vertex v
+    std::vector<uint8_t> uncolored;  // the number of uncolored vertices of each extension constraint
+    std::vector<uint8_t> uncolored_xor;  // the xor of the uncolored vertices of each extension constraint, which is the last one
+    std::vector<int> uncolored_verts;  // the first num_left entries are the uncolored extension vertices
+    std::vector<std::pair<int,unsigned int> > trail;  // the domains narrowed by forward checking, as (v, domain before), to undo them
+    std::vector<BIT_MASK> reason;  // reason[v] has the colored vertices whose colors narrowed domain[v], its conflict set
+    std::vector<BIT_MASK> reason_trail;  // reason[v] before each entry of trail
+    cNogoodTable nogoods;
+    
+#if SEARCH_STATS
+    cSearchStats stats;
+#endif
+    
+    cSearchState(int n,int num_colors)
+        : c(n), prev_c(n), max_color(n), color_mask(num_colors+1), forbidden_colors(n), root{0}, cur{1}, cur_mask{2}, worker{0},
+          cache_pending{false}
+    {
+        SEARCH_STAT(stats.init(n);)
+    }
+};
+
+
+class cWorkStealingQueue
+// A range of task indices owned by one worker thread.
+// The owner takes tasks from the front, and idle workers steal the back half of the range.
+{
+public:
+    std::mutex lock;
+    long long int next,end;  // the remaining tasks are next..end-1
+    
+    bool pop(long long int &task)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (next>=end)
+            return false;
+        task=next++;
+        return true;
+    }
+    
+    bool steal(long long int &steal_next,long long int &steal_end)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (next>=end)
+            return false;
+        steal_end=end;
+        end-=(end-next+1)/2;  // take the larger half, so that a single remaining task can be stolen
+        steal_next=end;
+        return true;
+    }
+};
+
+
+class cGraphInstance
+// An instance given in memory, as check_precoloring_extension in PrecoloringExtension.py takes it:
+// the four-set blockers are found from the graph, and there are no tendrils or symmetry pairs.
+{
+public:
+    int n=0;
+    int num_colors=0;
+    int num_precolored_verts=0;
+    std::vector<std::pair<int,int> > edges;
+    std::vector<char> is_recolor;  // indexed by vertices; a P4 or C4 cannot mix recolor vertices and extend vertices
+    std::vector<char> is_extend;
+};
+
+
+template<typename BIT_MASK>
+class cProblemInstance
+{
+public:
+    int n;  // number of vertices of the graph
+    std::vector<BIT_MASK> adj_pred_mask;  // bit mask of adjacent predecessors for each vertex
+    int num_colors;
+    int num_precolored_verts;
+    std::vector<std::vector<cFourSetBlocker> > FourSets;  // indexed by each vertex, gives the sets to check for the star chromatic condition on P4s and C4s.
+    std::vector<std::vector<cThreeSetBlocker> > ThreeSets;  // indexed by each vertex, gives the sets to check for the star chromatic condition from leaves of tendrils.
+    cBlockerArena blockers;  // FourSets and ThreeSets packed for the search, built after parsing
+    BIT_MASK tendril_leaves;  // bit array indicating which vertices are tendril leaves
+    std::vector<int> SymmetryPair;  // array where SymmetryPair[cur] is the lesser-indexed vertex in a symmetry pair
+    BIT_MASK symmetry_vertices;  // bit array indicating which vertices are the greater vertex in a symmetry pair
+    unsigned int three_set_colors[3];  // three_set_colors[type] has bit k set if color k on a leaf triggers a three-set blocker of that type
+    
+    // for the extension cache
+    std::vector<int> boundary_verts;  // the precolored vertices that the extension depends on
+    bool canonical_boundary;  // whether the extension does not depend on the names of the colors, so we can canonicalize them
+    bool use_extension_cache;
+    
+    // for the extension solver
+    bool use_extension_solver;
+    std::vector<uint8_t> unary_verts;  // the constraints with a single extension vertex, which only depend on the precoloring,
+    std::vector<cForbidRule> unary_rules;  // as the colors that unary_rules[i] forbids on unary_verts[i]
+    std::vector<cExtensionConstraint> extension_constraints;
+    std::vector<int> extension_constraint_start;  // the constraints of extension vertex v are listed at
+    std::vector<int> extension_constraint_list;   // extension_constraint_start[v-num_precolored_verts].. of this list
+    std::vector<uint8_t> initial_uncolored;  // num_extension_verts of each extension constraint
+    std::vector<uint8_t> initial_uncolored_xor;  // the xor of the extension vertices of each extension constraint
+    std::vector<char> extension_leaf;  // whether each extension vertex is a tendril leaf
+    std::vector<BIT_MASK> unary_reasons;  // the precolored vertices of the constraint of each unary rule
+    
+    // for parallelization
+    int parallel_job_number;
+    int parallel_num_jobs;
+    int parallel_depth;
+    
+    cSearchOptions options;
+    
+    static const int max_failures=100;  // we stop the search once this many failures have been found
+    std::atomic<int> total_failures;  // failures found so far, across all worker threads
+    std::mutex output_lock;  // keeps the output lines of different worker threads from interleaving
+    
+    // for checkpoints
+    // All active worker threads stop at a consistent point, and the last one to arrive writes the checkpoint.
+    std::vector<cWorkStealingQueue> *queues;  // the task queues of the worker threads, or nullptr without threads
+    cSearchCounters base_counters;  // the counters from before the worker threads started, or from the checkpoint we resumed from
+    std::vector<cSearchCounters> worker_counters;
+    std::vector<cWorkerCheckpoint> worker_checkpoints;
+    std::mutex checkpoint_lock;
+    std::condition_variable checkpoint_written;
+    std::atomic<bool> checkpoint_requested;
+    std::atomic<long long int> next_checkpoint_time;  // in seconds of std::chrono::steady_clock
+    int active_workers;  // worker threads that have not finished
+    int arrived_workers;  // worker threads waiting for the checkpoint to be written
+    long long int checkpoint_generation;  // number of checkpoints written
+    bool stopped_for_checkpoint;  // whether we stopped the search after the checkpoint for a stop signal
+    
+    bool estimating=false;  // whether the searches are extensions of the precolorings of random probes
+    cSearchCounters result_counters;  // the totals of the last search, for the result records of batch mode
+    std::vector<int> failing_precolorings;  // the colors of vertices 0..num_precolored_verts-1 of each failure, for the library and checkpoints
+#if SEARCH_STATS
+    std::vector<cSearchStats> worker_stats;  // the statistics of each worker thread, once it has finished
+#endif
+    
+    cProblemInstance(std::string file_input,
+                     int parallel_job_number,
+                     int parallel_num_jobs,
+                     int parallel_depth,
+                     const cSearchOptions &options);
+    cProblemInstance(const cGraphInstance &G,
+                     int parallel_job_number,
+                     int parallel_num_jobs,
+                     int parallel_depth,
+                     const cSearchOptions &options);
+    
+    bool verify_precoloring_extension();
+    bool decide_extension(const int *prefix);
+    void estimate_search_tree();
+    void emit_frontier();
+    void write_instance_file(const std::string &file_name);
+    void write_specialized_source(const std::string &file_name,const std::string &file_input);
+
+private:
+    void read_text_instance(const std::string &file_input);
+    void read_instance_file(const std::string &file_input);
+    void read_graph_instance(const cGraphInstance &G);
+    void prepare_search();
+    unsigned long long int fingerprint();
+    void set_first_color(cSearchState<BIT_MASK> &S);
+    void compute_forbidden_colors(cSearchState<BIT_MASK> &S);
+    void find_boundary_vertices();
+    void build_extension_solver();
+    bool extend_precoloring(cSearchState<BIT_MASK> &S,cSearchCounters &counters);
+    int extend_chronologically(cSearchState<BIT_MASK> &S,cSearchCounters &counters,int max_nodes);
+    bool extend_remaining(cSearchState<BIT_MASK> &S,cSearchCounters &counters,int num_left,int max_color,BIT_MASK &conflict);
+    int lookup_extension_cache(cSearchState<BIT_MASK> &S,cSearchCounters &counters);
+    void start_search(cSearchState<BIT_MASK> &S,const int *prefix,int root);
+    void resume_search(cSearchState<BIT_MASK> &S,const cWorkerCheckpoint &W);
+    bool checkpoint_due();
+    bool take_checkpoint(const cSearchState<BIT_MASK> *S,int worker);
+    void worker_finished(int worker);
+    void write_checkpoint();
+    void read_checkpoint();
+    int random_probe(cSearchState<BIT_MASK> &S,std::mt19937_64 &random_generator,std::vector<double> &weight,
+                     double &extension_work,bool &extends,cSearchCounters &counters);
+    std::vector<uint8_t> collect_frontier(cSearchState<BIT_MASK> &S,cSearchCounters &counters);
+    bool search(cSearchState<BIT_MASK> &S,cSearchCounters &counters,std::vector<uint8_t> *frontier);
+    void search_worker(int worker,std::vector<cWorkStealingQueue> &queues,const std::vector<uint8_t> &frontier,
+                       cSearchCounters &counters);
+#if SEARCH_STATS
+    void write_stats_file(const cSearchCounters &counters,const cSearchStats &stats,bool completed);
+#endif
+};
+
+
+template<typename BIT_MASK>
+cProblemInstance<BIT_MASK>::cProblemInstance(
+    std::string file_input,
+    int parallel_job_number,
+    int parallel_num_jobs,
+    int parallel_depth,
+    const cSearchOptions &options)
+    :  // initialization list
+    parallel_job_number{parallel_job_number},
+    parallel_num_jobs{parallel_num_jobs},
+    parallel_depth{parallel_depth},
+    options(options),
+    total_failures{0}
+{
+    if (cInstanceFile::is_instance_file(file_input))
+        read_instance_file(file_input);
+    else
+    {
+        read_text_instance(file_input);
+        blockers.build(FourSets,ThreeSets);
+        assert(blockers.matches(FourSets,ThreeSets));
+    }
+    prepare_search();
+}
+
+
+template<typename BIT_MASK>
+cProblemInstance<BIT_MASK>::cProblemInstance(
+    const cGraphInstance &G,
+    int parallel_job_number,
+    int parallel_num_jobs,
+    int parallel_depth,
+    const cSearchOptions &options)
+    :  // initialization list
+    parallel_job_number{parallel_job_number},
+    parallel_num_jobs{parallel_num_jobs},
+    parallel_depth{parallel_depth},
+    options(options),
+    total_failures{0}
+{
+    read_graph_instance(G);
+    blockers.build(FourSets,ThreeSets);
+    assert(blockers.matches(FourSets,ThreeSets));
+    prepare_search();
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::prepare_search()
+    // the setup after the instance is read, which is the same for all of its sources
+{
+    int num_tendril_leaves=0,num_symmetry_pairs=0;
+    for (int v=0; v<n; v++)
+    {
+        if ((((BIT_MASK)1)<<v)&tendril_leaves)
+            num_tendril_leaves++;
+        if ((((BIT_MASK)1)<<v)&symmetry_vertices)
+            num_symmetry_pairs++;
+    }
+    if (!options.quiet)
+    {
+        printf("n=%d\n",n);
+        printf("num_colors=%d\n",num_colors);
+        printf("num_precolored_verts=%d\n",num_precolored_verts);
+        printf("blockers: %d four-set, %d three-set; %d tendril leaves, %d symmetry pairs\n",
+               blockers.four_start[n],blockers.three_start[n],num_tendril_leaves,num_symmetry_pairs);
+    }
+    
+    for (int type=0; type<3; type++)
+    {
+        three_set_colors[type]=0;
+        for (int k=num_colors; k>0; k--)
+            if (k & type)
+                three_set_colors[type]|=1u<<k;
+    }
+    
+#if STAR_PRECOLOR_SPECIALIZED
+    if ((n!=specialized_n) || (num_colors!=specialized_num_colors) || (num_precolored_verts!=specialized_num_precolored_verts) ||
+        (fingerprint()!=specialized_fingerprint))
+    {
+        printf("ERROR: this build is specialized for the instance %s, and the instance read does not match it\n",specialized_file_input);
+        exit(99);
+    }
+#endif
+    
+    find_boundary_vertices();
+    build_extension_solver();
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::read_text_instance(const std::string &file_input)
+    // parses the text format of prepare.sage into FourSets and ThreeSets and the bit masks
+{
+    std::string line;
+    std::ifstream file_in(file_input);
+    if (file_in.is_open())
+        while (getline(file_in,line))
+        {
+            //printf("line: %s\n",line.c_str());
+            
+            if (line.rfind("n=",0)==0)
+            {
+                n=std::stoi(line.substr(2));
+                adj_pred_mask.resize(n);  // initialize to be indexed by vertices
+                FourSets.resize(n);  // initialize to be indexed by vertices
+                ThreeSets.resize(n);  // initialize to be indexed by vertices
+                tendril_leaves=0;
+                SymmetryPair.resize(n);
+                symmetry_vertices=0;
+                if (n>(int)sizeof(BIT_MASK)*8)
+                {
+                    printf("ERROR: n=%d is larger than BIT_MASK (%d bits)\n",n,(int)sizeof(BIT_MASK)*8);
+                    exit(99);
+                }
+            }
+            else if (line.rfind("num_colors=",0)==0)
+            {
+                num_colors=std::stoi(line.substr(11));
+                if (num_colors>30)
+                {
+                    printf("ERROR: num_colors=%d is larger than the color bit masks allow (30 colors)\n",num_colors);
+                    exit(99);
+                }
+            }
+            else if (line.rfind("num_precolored_verts=",0)==0)
+            {
+                num_precolored_verts=std::stoi(line.substr(21));
+            }
+            else if (line.rfind("G=",0)==0)
+            {
+                std::string mapping("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz@#");
+                // The first bit is the least significant bit.
+                
+                int pos=2;
+                int value=0;  // 6-bit value
+                int bits_left_in_value=0;
+                int count=0;
+                for (int j=0; j<n; ++j)
+                    for (int i=0; i<j; ++i)
+                    {
+                        if (bits_left_in_value==0)
+                        {
+                            // We read in the next character and decode it.
+                            value=mapping.find(line[pos]);
+                            //printf("Read in character at pos=%d, value=%d\n",pos,value);
+                            pos++;
+                            bits_left_in_value=6;
+                        }
+                        
+                        if ((value & 1)!=0)  // test whether the bottom bit is nonzero
+                        {
+                            // there is an edge between i and j.
+                            adj_pred_mask[j]|=((BIT_MASK)1)<<i;
+                            //printf("There is an edge between %2d and %2d\n",i,j);
                         }
-                    
-                    if (j<0)
-                        // no star coloring conditions were violated, so c[cur] is a good color.
+                        
+                        value>>=1;
+                        bits_left_in_value--;
+                    }
+            }
+            else if (line.rfind("B=",0)==0)  // four-vertex set blocker
+            {
+                int same1,same2,other1,other2;
+                sscanf(line.substr(2).c_str(),
+                    "%d,%d,%d,%d",&same1,&same2,&other1,&other2);
+                // we assume same1>same2
+                FourSets[same1].push_back(cFourSetBlocker(same2,other1,other2));
+                //printf("There is a four-set blocker %d,%d and %d,%d\n",same1,same2,other1,other2);
+            }
+            else if (
+                        // three-vertex set blocker from tendril
+                     (line.rfind("T=",0)==0) ||
+                     (line.rfind("U=",0)==0) 
+                    )
+            {
+                int leaf,other1,other2,type;
+                type=(line.rfind("T=",0)==0) ? 2 : 1;
+                sscanf(line.substr(2).c_str(),
+                    "%d,%d,%d",&leaf,&other1,&other2);
+                // we assume other1>other2
+                if (leaf>other1)
+                    ThreeSets[leaf  ].push_back(cThreeSetBlocker(leaf,other1,other2,type));
+                else
+                    ThreeSets[other1].push_back(cThreeSetBlocker(leaf,other1,other2,type));
+                //printf("There is a three-set blocker; leaf:%d other:%d and %d  type=%d\n",leaf,other1,other2,type);
+            }
+            else if (line.rfind("L=",0)==0)  // tendril leaf
+            {
+                int leaf;
+                sscanf(line.substr(2).c_str(),
+                    "%d",&leaf);
+                //printf("tendril leaf %d\n",leaf);
+                tendril_leaves|=((BIT_MASK)1)<<leaf;
+                //printf("tendril_leaves=%lx\n",tendril_leaves);
+                if (leaf==0)
+                {
+                    printf("ERROR: cannot have vertex 0 be a leaf vertex\n");
+                    // Because we never allow vertex 0 to be any color other than 1, it cannot be a leaf vertex.
+                    exit(99);
+                }
+            }
+            else if (line.rfind("S=",0)==0)  // symmetry pair
+            {
+                int pair1,pair2;
+                sscanf(line.substr(2).c_str(),
+                    "%d,%d",&pair1,&pair2);
+                // we assume pair1<pair2
+                //printf("symmetry pair %d,%d\n",pair1,pair2);
+                symmetry_vertices|=((BIT_MASK)1)<<pair2;
+                SymmetryPair[pair2]=pair1;
+            }
+        }
+    
+    // no need to close the file, since the destructor automatically does this when the object goes out of scope.
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::read_graph_instance(const cGraphInstance &G)
+    // Finds the four-set blockers of G as check_precoloring_extension does, for each induced P4 or C4 at its largest vertex cur.
+    // The vertices of either is two pairs that alternate along it, and the blocker is the pair of cur and the other pair.
+    // We follow the paths a-b-c-d, taking each path once with a<d, and each cycle once with a its least vertex and b<d.
+{
+    n=G.n;
+    num_colors=G.num_colors;
+    num_precolored_verts=G.num_precolored_verts;
+    adj_pred_mask.assign(n,0);
+    FourSets.assign(n,std::vector<cFourSetBlocker>());
+    ThreeSets.assign(n,std::vector<cThreeSetBlocker>());
+    tendril_leaves=0;
+    SymmetryPair.assign(n,0);
+    symmetry_vertices=0;
+    
+    for (const std::pair<int,int> &e : G.edges)
+        if (e.first!=e.second)
+            adj_pred_mask[std::max(e.first,e.second)]|=((BIT_MASK)1)<<std::min(e.first,e.second);
+    auto adjacent=[&](int u,int v)
+    {
+        return (u<v) ? (bool)((adj_pred_mask[v]>>u)&1) : (bool)((adj_pred_mask[u]>>v)&1);
+    };
+    std::vector<std::vector<int> > neighbors(n);
+    for (int v=0; v<n; v++)
+        for (int u=0; u<n; u++)
+            if ((u!=v) && adjacent(u,v))
+                neighbors[v].push_back(u);
+    
+    for (int b=0; b<n; b++)
+        for (int c : neighbors[b])
+            for (int a : neighbors[b])
+            {
+                if ((a==c) || adjacent(a,c))
+                    continue;
+                for (int d : neighbors[c])
+                {
+                    if ((d==b) || (d==a) || adjacent(b,d))
+                        continue;
+                    if (adjacent(a,d) ? ((a>b) || (a>c) || (a>d) || (b>d)) : (a>d))
+                        continue;  // we take this path or cycle from another end
+                    if ((G.is_recolor[a] || G.is_recolor[b] || G.is_recolor[c] || G.is_recolor[d]) &&
+                        (G.is_extend[a]  || G.is_extend[b]  || G.is_extend[c]  || G.is_extend[d]))
+                        continue;  // we cannot mix recolor_verts and extend_verts in a P4 or C4.
+                    const int cur=std::max(std::max(a,b),std::max(c,d));
+                    if ((cur==a) || (cur==c))
+                        FourSets[cur].push_back(cFourSetBlocker(a+c-cur,b,d));
+                    else
+                        FourSets[cur].push_back(cFourSetBlocker(b+d-cur,a,c));
+                }
+            }
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::read_instance_file(const std::string &file_input)
+    // loads a binary instance file written by write_instance_file; the blocker arena is copied as it is
+{
+    cInstanceFile F;
+    F.map(file_input);
+    n=F.n;
+    num_colors=F.num_colors;
+    num_precolored_verts=F.num_precolored_verts;
+    if (n>(int)sizeof(BIT_MASK)*8)
+    {
+        printf("ERROR: n=%d is larger than BIT_MASK (%d bits)\n",n,(int)sizeof(BIT_MASK)*8);
+        exit(99);
+    }
+    if (num_colors>30)
+    {
+        printf("ERROR: num_colors=%d is larger than the color bit masks allow (30 colors)\n",num_colors);
+        exit(99);
+    }
+    
+    adj_pred_mask.resize(n);
+    for (int v=0; v<n; v++)
+        adj_pred_mask[v]=words_to_mask<BIT_MASK>(F.adj_pred_words+(size_t)v*F.num_words,F.num_words);
+    tendril_leaves   =words_to_mask<BIT_MASK>(F.tendril_leaf_words,F.num_words);
+    symmetry_vertices=words_to_mask<BIT_MASK>(F.symmetry_vertex_words,F.num_words);
+    SymmetryPair.assign(F.symmetry_pair,F.symmetry_pair+n);
+    blockers.assign(n,F.four_start,F.three_start,F.storage);
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::write_instance_file(const std::string &file_name)
+{
+    cInstanceFile F;
+    F.n=n;
+    F.num_colors=num_colors;
+    F.num_precolored_verts=num_precolored_verts;
+    F.num_words=(n+63)/64;
+    F.num_four=blockers.four_start[n];
+    F.num_three=blockers.three_start[n];
+    
+    std::vector<uint64_t> mask_words((n+2)*F.num_words);
+    for (int v=0; v<n; v++)
+        mask_to_words(adj_pred_mask[v],F.num_words,&mask_words[v*F.num_words]);
+    mask_to_words(tendril_leaves   ,F.num_words,&mask_words[n*F.num_words]);
+    mask_to_words(symmetry_vertices,F.num_words,&mask_words[(n+1)*F.num_words]);
+    F.write(file_name,mask_words,SymmetryPair,blockers);
+}
+
+
+template<typename BIT_MASK>
+unsigned long long int cProblemInstance<BIT_MASK>::fingerprint()
+    // a 64-bit FNV-1a hash of the instance as the search uses it, so that a specialized build can check its input
+{
+    unsigned long long int hash=14695981039346656037ull;
+    auto add=[&](unsigned long long int value)
+    {
+        for (int i=0; i<8; i++)
+        {
+            hash^=(value>>(8*i))&0xff;
+            hash*=1099511628211ull;
+        }
+    };
+    const int num_words=(n+63)/64;
+    std::vector<uint64_t> words(num_words);
+    add(n);
+    add(num_colors);
+    add(num_precolored_verts);
+    for (int v=0; v<n; v++)
+    {
+        mask_to_words(adj_pred_mask[v],num_words,words.data());
+        for (uint64_t w : words)
+            add(w);
+        add(SymmetryPair[v]);
+        add(blockers.four_start[v+1]);
+        add(blockers.three_start[v+1]);
+    }
+    for (const BIT_MASK &mask : {tendril_leaves,symmetry_vertices})
+    {
+        mask_to_words(mask,num_words,words.data());
+        for (uint64_t w : words)
+            add(w);
+    }
+    for (uint8_t byte : blockers.storage)
+        add(byte);
+    return hash;
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::write_specialized_source(const std::string &file_name,const std::string &file_input)
+    // Writes a source file that builds star_precolor for this instance only, with compute_forbidden_colors unrolled:
+    // for each vertex, a case of a switch with its predecessors and its blockers as constants.
+    // The predecessors of cur are all colored when we compute its forbidden colors, so each forbids its own color.
+{
+    FILE *f=fopen(file_name.c_str(),"wt");
+    if (f==nullptr)
+    {
+        printf("ERROR: could not write %s\n",file_name.c_str());
+        exit(99);
+    }
+    fprintf(f,"// Written by star_precolor --codegen for the instance %s; build it with -I for star_precolor.cpp.\n\n",file_input.c_str());
+    fprintf(f,"#define STAR_PRECOLOR_SPECIALIZED 1\n\n");
+    fprintf(f,"static const char *specialized_file_input=\"%s\";\n",file_input.c_str());
+    fprintf(f,"static const unsigned long long int specialized_fingerprint=%lluull;\n",fingerprint());
+    fprintf(f,"constexpr int specialized_n=%d;\n",n);
+    fprintf(f,"constexpr int specialized_num_colors=%d;\n",num_colors);
+    fprintf(f,"constexpr int specialized_num_precolored_verts=%d;\n\n",num_precolored_verts);
+    fprintf(f,"static inline unsigned int specialized_forbidden_colors(int cur,const int *c)\n{\n");
+    fprintf(f,"    unsigned int forbidden=0;\n");
+    fprintf(f,"    switch (cur)\n    {\n");
+    for (int v=1; v<n; v++)
+    {
+        const char *role=(num_precolored_verts<=v) ? "extension" : "precolored";
+        if ((((BIT_MASK)1)<<v)&tendril_leaves)
+            role=(num_precolored_verts<=v) ? "extension, tendril leaf" : "precolored, tendril leaf";
+        fprintf(f,"        case %d:  // %s\n",v,role);
+        for (int u=0; u<v; u++)
+            if ((((BIT_MASK)1)<<u)&adj_pred_mask[v])
+                fprintf(f,"            forbidden|=1u<<c[%d];\n",u);
+        for (int j=blockers.four_start[v]; j<blockers.four_start[v+1]; j++)
+            fprintf(f,"            if (c[%d]==c[%d]) forbidden|=1u<<c[%d];\n",
+                    blockers.four_other1()[j],blockers.four_other2()[j],blockers.four_same()[j]);
+        for (int j=blockers.three_start[v]; j<blockers.three_start[v+1]; j++)
+            if (blockers.three_leaf()[j]==v)
+                fprintf(f,"            if (c[%d]==c[%d]) forbidden|=0x%xu;\n",
+                        blockers.three_other1()[j],blockers.three_other2()[j],three_set_colors[blockers.three_type()[j]]);
+            else
+                fprintf(f,"            if (c[%d]&%d) forbidden|=1u<<c[%d];\n",
+                        blockers.three_leaf()[j],blockers.three_type()[j],blockers.three_other2()[j]);
+        fprintf(f,"            break;\n");
+    }
+    fprintf(f,"    }\n");
+    fprintf(f,"    return forbidden;\n}\n\n");
+    fprintf(f,"#include \"star_precolor.cpp\"\n");
+    fclose(f);
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::set_first_color(cSearchState<BIT_MASK> &S)
+    // put the first color to try on the new S.cur
+{
+    int cur=S.cur;
+    std::vector<int> &c=S.c;
+    
+    if (S.cur_mask&tendril_leaves)  // cur is a tendril leaf
+    {
+        c[cur]=2;  // only two colors (2 and 1) for tendril leaves
+        //printf("cur=%d is a tendril leaf, only using 2 colors\n",cur);
+        return;
+    }
+    
+    // The colors are interchangeable, so we only use the colors already used on vertices 0..cur-1,
+    // and one new color, which is the largest color used so far plus one.
+    // (The colors of tendril leaves are not real colors, so they are not counted.)
+    const int max_new_color=std::min(S.max_color[cur-1]+1,num_colors);
+    
+    if (S.cur_mask&symmetry_vertices)  // cur is in a symmetry pair
+    {
+        //printf("cur=%d is a symmetry pair of %d, so using fewer colors\n",cur,SymmetryPair[cur]);
+        const int pair=SymmetryPair[cur];
+        const int max_before_pair=(pair>0) ? S.max_color[pair-1] : 0;
+        if (c[pair]>max_before_pair)
+            // pair got a new color, and then swapping the two vertices and renaming the colors does not make the color of cur smaller,
+            // so we cannot restrict cur beyond the new colors
+            c[cur]=max_new_color;
+        else
+            c[cur]=std::min(c[pair]-1,max_new_color);  // the assumption is that the vertices in the symmetry pair are adjacent, or at least should not be the same.
+    }
+    else
+        c[cur]=max_new_color;
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::compute_forbidden_colors(cSearchState<BIT_MASK> &S)
+    // Computes the colors that conflict with the colors of the predecessors of the new S.cur,
+    // in one pass over its adjacencies and blockers.
+{
+    const int cur=S.cur;
+    const std::vector<int> &c=S.c;
+#if STAR_PRECOLOR_SPECIALIZED && !SEARCH_STATS
+    S.forbidden_colors[cur]=specialized_forbidden_colors(cur,c.data());
+    return;
+#endif
+    unsigned int forbidden=0;
+    
+    for (int k=num_colors; k>0; k--)
+        if (S.color_mask[k]&adj_pred_mask[cur])  // color k is used in the neighborhood
+            forbidden|=1u<<k;
+    SEARCH_STAT(S.stats.rejected[0]+=__builtin_popcount(forbidden); unsigned int counted=forbidden;)
+    
+    // If c[cur]==c[same] and c[other1]==c[other2], this is a violation of the star chromatic condition,
+    // so each four-set blocker forbids at most the one color c[same].
+    const uint8_t *same=blockers.four_same();
+    const uint8_t *other1=blockers.four_other1();
+    const uint8_t *other2=blockers.four_other2();
+    for (int j=blockers.four_start[cur+1]-1; j>=blockers.four_start[cur]; j--)
+        if (c[other1[j]]==c[other2[j]])
+            forbidden|=1u<<c[same[j]];
+    SEARCH_STAT(S.stats.rejected[1]+=__builtin_popcount(forbidden&~counted); counted=forbidden;)
+    
+    // A three-set blocker is stored with whichever of leaf and other1 is larger.
+    const uint8_t *leaf=blockers.three_leaf();
+    const uint8_t *type=blockers.three_type();
+    other1=blockers.three_other1();
+    other2=blockers.three_other2();
+    for (int j=blockers.three_start[cur+1]-1; j>=blockers.three_start[cur]; j--)
+        if (leaf[j]==cur)
+        {
+            if (c[other1[j]]==c[other2[j]])  // every color of this type is forbidden on the leaf
+                forbidden|=three_set_colors[type[j]];
+        }
+        else  // cur is other1
+        {
+            if (c[leaf[j]] & type[j])
+                forbidden|=1u<<c[other2[j]];
+        }
+    SEARCH_STAT(S.stats.rejected[2]+=__builtin_popcount(forbidden&~counted);)
+    
+    S.forbidden_colors[cur]=forbidden;
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::find_boundary_vertices()
+    // The boundary vertices are the precolored vertices that the extend vertices see,
+    // through adj_pred_mask, as members of blockers, or as the lesser vertex of a symmetry pair
+    // (together with the vertices before it, which decide whether it has a new color).
+{
+    const BIT_MASK mask_precolored_vertices=first_bits_mask<BIT_MASK>(num_precolored_verts);
+    BIT_MASK boundary=0;
+    bool color_names_matter=false;
+    
+    for (int v=num_precolored_verts; v<n; v++)
+    {
+        boundary|=adj_pred_mask[v]&mask_precolored_vertices;
+        for (int j=blockers.four_start[v]; j<blockers.four_start[v+1]; j++)
+        {
+            boundary|=((BIT_MASK)1)<<blockers.four_same()[j];
+            boundary|=((BIT_MASK)1)<<blockers.four_other1()[j];
+            boundary|=((BIT_MASK)1)<<blockers.four_other2()[j];
+        }
+        for (int j=blockers.three_start[v]; j<blockers.three_start[v+1]; j++)
+        {
+            boundary|=((BIT_MASK)1)<<blockers.three_leaf()[j];
+            boundary|=((BIT_MASK)1)<<blockers.three_other1()[j];
+            boundary|=((BIT_MASK)1)<<blockers.three_other2()[j];
+            color_names_matter=true;  // the colors 1 and 2 of tendril leaves are special
+        }
+        if ((((BIT_MASK)1)<<v)&tendril_leaves)
+            color_names_matter=true;
+        if ((((BIT_MASK)1)<<v)&symmetry_vertices)
+        {
+            if (SymmetryPair[v]<num_precolored_verts)
+                boundary|=first_bits_mask<BIT_MASK>(SymmetryPair[v]+1);
+            color_names_matter=true;
+        }
+    }
+    
+    boundary_verts.clear();
+    for (int v=0; v<num_precolored_verts; v++)
+        if ((((BIT_MASK)1)<<v)&boundary)
+            boundary_verts.push_back(v);
+    canonical_boundary=!color_names_matter;
+    
+    // If every precolored vertex is on the boundary, then two precolorings can only share an entry
+    // when we canonicalize the colors.
+    // A lookup costs about as much as extending a few vertices, so by default we only cache longer extensions.
+    if (options.cache_entries<0)
+        options.cache_entries=(n-num_precolored_verts>=8) ? (1<<20) : 0;
+    
+    // Below parallel_depth, each job only extends part of each precoloring, so the outcomes are not comparable.
+    use_extension_cache=(options.cache_entries>0) && (num_precolored_verts<n) &&
+                        ((parallel_depth<num_precolored_verts) || (parallel_num_jobs==1)) &&
+                        (((int)boundary_verts.size()<num_precolored_verts) || canonical_boundary);
+    
+    if (!options.quiet)
+        printf("extension cache: %d boundary vertices of %d precolored vertices, %s colors, %s\n",
+               (int)boundary_verts.size(),num_precolored_verts,
+               canonical_boundary ? "canonicalized" : "fixed",
+               use_extension_cache ? "enabled" : "disabled");
+}
+
+
+template<typename BIT_MASK>
+int cProblemInstance<BIT_MASK>::lookup_extension_cache(cSearchState<BIT_MASK> &S,cSearchCounters &counters)
+    // Called when all precolored vertices have been colored.
+    // Returns 1 if the precoloring is known to extend, 0 if it is known to be a failure, and -1 if we need to extend it;
+    // in the last case, the outcome is inserted into the cache once it is known.
+{
+    uint64_t *key=S.cache_key.data();
+    for (int i=0; i<S.cache.key_words; i++)
+        key[i]=0;
+    if (canonical_boundary)
+    {
+        // rename the colors in the order in which they first appear on the boundary vertices
+        char rename[32]={0};
+        char next_color=1;
+        for (size_t i=0; i<boundary_verts.size(); i++)
+        {
+            int color=S.c[boundary_verts[i]];
+            if (rename[color]==0)
+                rename[color]=next_color++;
+            key[i/12]|=((uint64_t)rename[color])<<(5*(i%12));
+        }
+    }
+    else
+        for (size_t i=0; i<boundary_verts.size(); i++)
+            key[i/12]|=((uint64_t)S.c[boundary_verts[i]])<<(5*(i%12));
+    
+    counters.cache_lookups++;
+    int found=S.cache.find(key);
+    if (found>=0)
+    {
+        counters.cache_hits++;
+        S.cache_pending=false;
+        return found;
+    }
+    S.cache_pending=true;
+    return -1;
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::build_extension_solver()
+    // Lists the adjacencies and blockers that involve the extension vertices, for the extension solver.
+    // The solver treats the colors above the largest color used so far as interchangeable, as set_first_color does,
+    // so it needs the colors of tendril leaves to be flags that only three-set blockers read,
+    // and it does not know the symmetry pairs; otherwise we extend with the chronological search.
+{
+    const int npv=num_precolored_verts;
+    const char *reason=nullptr;  // why the solver does not apply
+    std::vector<cExtensionConstraint> constraints;
+    for (int v=npv; v<n; v++)
+    {
+        // c[v]==c[u]
+        for (int u=0; u<v; u++)
+            if ((((BIT_MASK)1)<<u)&adj_pred_mask[v])
+            {
+                cExtensionConstraint C={2,0,{(uint8_t)v,(uint8_t)u},{{(uint8_t)u,(uint8_t)u,(uint8_t)u,0,0},
+                                                                   {(uint8_t)v,(uint8_t)v,(uint8_t)v,0,0}}};
+                constraints.push_back(C);
+            }
+        // c[v]==c[same] and c[other1]==c[other2]
+        for (int j=blockers.four_start[v]; j<blockers.four_start[v+1]; j++)
+        {
+            const uint8_t a=v,b=blockers.four_same()[j],o1=blockers.four_other1()[j],o2=blockers.four_other2()[j];
+            cExtensionConstraint C={4,0,{a,b,o1,o2},{{o1,o2,b,0,0},{o1,o2,a,0,0},{a,b,o2,0,0},{a,b,o1,0,0}}};
+            constraints.push_back(C);
+        }
+        // (c[leaf] & type) and c[other1]==c[other2]
+        for (int j=blockers.three_start[v]; j<blockers.three_start[v+1]; j++)
+        {
+            const uint8_t leaf=blockers.three_leaf()[j],o1=blockers.three_other1()[j],o2=blockers.three_other2()[j];
+            const uint8_t type=blockers.three_type()[j];
+            cExtensionConstraint C={3,0,{leaf,o1,o2},{{o1,o2,0,0,three_set_colors[type]},{leaf,0,o2,type,0},{leaf,0,o1,type,0}}};
+            constraints.push_back(C);
+            if ((((((BIT_MASK)1)<<leaf)&tendril_leaves)==0) || ((((BIT_MASK)1)<<o1)&tendril_leaves) || ((((BIT_MASK)1)<<o2)&tendril_leaves))
+                reason="a three-set blocker whose leaf is not a tendril leaf, or whose other vertices are";
+        }
+        if ((((BIT_MASK)1)<<v)&symmetry_vertices)
+            reason="a symmetry pair among the extension vertices";
+    }
+    
+    // the unary constraints become domains, and the others are listed for each of their extension vertices
+    unary_verts.clear();
+    unary_rules.clear();
+    unary_reasons.clear();
+    extension_constraints.clear();
+    extension_constraint_start.assign(n-npv+1,0);
+    for (size_t k=0; k<constraints.size(); k++)
+    {
+        cExtensionConstraint &C=constraints[k];
+        for (int i=0; i<C.num_verts; i++)
+        {
+            if ((C.num_verts!=3) && ((((BIT_MASK)1)<<C.vert[i])&tendril_leaves))
+                reason="a tendril leaf in an adjacency or a four-set blocker";
+            for (int j=0; j<i; j++)
+                if (C.vert[j]==C.vert[i])
+                    reason="a blocker with a repeated vertex";
+            if (C.vert[i]>=npv)
+                C.num_extension_verts++;
+        }
+        for (int i=0; i<C.num_verts; i++)
+            if (C.vert[i]>=npv)
+            {
+                if (C.num_extension_verts==1)
+                {
+                    unary_verts.push_back(C.vert[i]);
+                    unary_rules.push_back(C.rule[i]);
+                    BIT_MASK reason=0;
+                    for (int j=0; j<C.num_verts; j++)
+                        if (j!=i)
+                            reason|=((BIT_MASK)1)<<C.vert[j];
+                    unary_reasons.push_back(reason);
+                }
+                else
+                    extension_constraint_start[C.vert[i]-npv+1]++;
+            }
+        if (C.num_extension_verts>=2)
+            extension_constraints.push_back(C);
+    }
+    
+    initial_uncolored.resize(extension_constraints.size());
+    initial_uncolored_xor.assign(extension_constraints.size(),0);
+    for (int i=0; i<n-npv; i++)
+        extension_constraint_start[i+1]+=extension_constraint_start[i];
+    extension_constraint_list.resize(extension_constraint_start[n-npv]);
+    std::vector<int> pos(extension_constraint_start.begin(),extension_constraint_start.end()-1);
+    for (size_t k=0; k<extension_constraints.size(); k++)
+    {
+        const cExtensionConstraint &C=extension_constraints[k];
+        initial_uncolored[k]=C.num_extension_verts;
+        for (int i=0; i<C.num_verts; i++)
+            if (C.vert[i]>=npv)
+            {
+                initial_uncolored_xor[k]^=C.vert[i];
+                extension_constraint_list[pos[C.vert[i]-npv]++]=k;
+            }
+    }
+    extension_leaf.assign(n-npv,0);
+    for (int v=npv; v<n; v++)
+        extension_leaf[v-npv]=(bool)((((BIT_MASK)1)<<v)&tendril_leaves);
+    
+    if (!options.extension_solver)
+        reason="--chronological-extension";
+    else if (parallel_depth>=npv)
+        reason="parallel_depth being among the extension vertices";  // the jobs split the extensions themselves
+    use_extension_solver=(npv<n) && (reason==nullptr);
+    
+    if (!options.quiet && (npv<n))
+    {
+        if (use_extension_solver)
+            printf("extension solver: forward checking on %d extension vertices, %d constraints between them\n",
+                   n-npv,(int)extension_constraints.size());
+        else
+            printf("extension solver: chronological search, because of %s\n",reason);
+    }
+}
+
+
+template<typename BIT_MASK>
+bool cProblemInstance<BIT_MASK>::extend_precoloring(cSearchState<BIT_MASK> &S,cSearchCounters &counters)
+    // Decides whether the precoloring of vertices 0..num_precolored_verts-1 in S extends to the extension vertices.
+    // This is forward checking: each extension vertex has a domain of remaining colors, and once a constraint has
+    // a single uncolored vertex, the colors it forbids there are removed, so a dead end shows as an empty domain.
+    // We color the vertex with the fewest remaining choices next, as in DSATUR.
+    // A failure leaves a conflict set of precolored vertices whose colors alone make it fail, which we keep as a nogood.
+{
+    // Most precolorings extend after a few nodes of the chronological search, which costs less than setting up the domains,
+    // so we only set them up for the precolorings that take longer, which are the ones that fail or nearly fail.
+    // Failures are rare, so when we keep nogoods, the solver goes over each of them again to find its conflict set.
+    const bool learn=(S.nogoods.max_entries>0);
+    const int outcome=extend_chronologically(S,counters,4*(n-num_precolored_verts));
+    if ((outcome==1) || ((outcome==0) && !learn))
+        return outcome==1;
+    
+    const int npv=num_precolored_verts;
+    if (S.domain.empty())
+    {
+        S.domain.resize(n);
+        S.reason.resize(n);
+        S.uncolored_verts.resize(n-npv);
+    }
+    const unsigned int all_colors=((2u<<num_colors)-1)&~1u;
+    for (int v=npv; v<n; v++)
+    {
+        S.domain[v]=extension_leaf[v-npv] ? 6u : all_colors;  // colors 2 and 1 for tendril leaves
+        S.reason[v]=0;
+        S.uncolored_verts[v-npv]=v;
+    }
+    
+    const int *c=S.c.data();
+    for (size_t i=0; i<unary_verts.size(); i++)
+    {
+        const unsigned int forbidden=S.domain[unary_verts[i]]&unary_rules[i].forbidden(c);
+        if (forbidden)
+        {
+            S.domain[unary_verts[i]]^=forbidden;
+            S.reason[unary_verts[i]]|=unary_reasons[i];
+            SEARCH_STAT(S.stats.rejected[unary_rules[i].kind()]+=__builtin_popcount(forbidden);)
+        }
+    }
+    bool extends=true;
+    BIT_MASK conflict=0;
+    for (int v=npv; (v<n) && extends; v++)
+        if (S.domain[v]==0)
+        {
+            extends=false;
+            conflict=S.reason[v];
+        }
+    
+    if (extends)
+    {
+        S.uncolored=initial_uncolored;
+        S.uncolored_xor=initial_uncolored_xor;
+        S.trail.clear();
+        S.reason_trail.clear();
+        extends=extend_remaining(S,counters,n-npv,S.max_color[npv-1],conflict);
+    }
+    
+    if (!extends && learn)
+    {
+        std::vector<uint8_t> nogood;
+        for (int v=0; v<npv; v++)
+            if ((((BIT_MASK)1)<<v)&conflict)
+            {
+                nogood.push_back(v);
+                nogood.push_back(c[v]);
+            }
+        // with the extension cache, a nogood on all of the boundary vertices only repeats what the cache knows
+        if (!use_extension_cache || (nogood.size()/2<boundary_verts.size()))
+        {
+            S.nogoods.insert(nogood);
+            counters.nogoods_learned++;
+        }
+    }
+    return extends;
+}
+
+
+template<typename BIT_MASK>
+int cProblemInstance<BIT_MASK>::extend_chronologically(cSearchState<BIT_MASK> &S,cSearchCounters &counters,int max_nodes)
+    // The chronological search below the precoloring, as search does it, but stopped after max_nodes nodes.
+    // Returns 1 if the precoloring extends, 0 if it does not, and -1 if we stopped.
+{
+    const int npv=num_precolored_verts;
+    int cur=npv;
+    BIT_MASK cur_mask=((BIT_MASK)1)<<cur;
+    int outcome=-1;
+    S.cur=cur;
+    S.cur_mask=cur_mask;
+    set_first_color(S);
+    compute_forbidden_colors(S);
+    while (true)
+    {
+        const unsigned int allowed_colors=((2u<<S.c[cur])-1) & ~S.forbidden_colors[cur] & ~1u;
+        if (allowed_colors==0)  // backtrack
+        {
+            SEARCH_STAT(S.stats.backtracks[cur]++;)
+            cur--;
+            cur_mask>>=1;
+            if (cur<npv)
+            {
+                outcome=0;
+                break;
+            }
+            S.color_mask[S.c[cur]]^=cur_mask;
+            S.c[cur]--;
+            continue;
+        }
+        
+        S.c[cur]=31-__builtin_clz(allowed_colors);
+        S.color_mask[S.c[cur]]|=cur_mask;
+        S.max_color[cur]=(cur_mask&tendril_leaves) ? S.max_color[cur-1] : std::max(S.max_color[cur-1],S.c[cur]);
+        counters.num_nodes++;
+        SEARCH_STAT(S.stats.nodes[cur]++;)
+        cur++;
+        cur_mask<<=1;
+        if (cur==n)
+        {
+            outcome=1;
+            break;
+        }
+        if (--max_nodes<=0)
+            break;
+        S.cur=cur;
+        S.cur_mask=cur_mask;
+        set_first_color(S);
+        compute_forbidden_colors(S);
+    }
+    
+    for (int v=npv; v<cur; v++)  // the search expects no colors on the extension vertices
+        S.color_mask[S.c[v]]^=((BIT_MASK)1)<<v;
+    return outcome;
+}
+
+
+template<typename BIT_MASK>
+bool cProblemInstance<BIT_MASK>::extend_remaining(cSearchState<BIT_MASK> &S,cSearchCounters &counters,int num_left,int max_color,
+                                                  BIT_MASK &conflict)
+    // colors the num_left uncolored extension vertices, where max_color is the largest color used so far;
+    // if they cannot be colored, conflict is set to colored vertices whose colors are enough to make it fail
+{
+    if (num_left==0)
+        return true;
+    
+    // The colors above max_color are interchangeable, and no constraint forbids them on a vertex that is not a tendril leaf,
+    // since the colors that are forbidden are colors of colored vertices, so we only try the least of them.
+    const int npv=num_precolored_verts;
+    const unsigned int real_colors=(2u<<std::min(max_color+1,num_colors))-1;
+    int *uncolored_verts=S.uncolored_verts.data();
+    int best=0;
+    int best_choices=33;
+    for (int i=0; (i<num_left) && (best_choices>1); i++)  // a single choice cannot be beaten
+    {
+        const int v=uncolored_verts[i];
+        const int num_choices=__builtin_popcount(extension_leaf[v-npv] ? S.domain[v] : S.domain[v]&real_colors);
+        if (num_choices<best_choices)
+        {
+            best=i;
+            best_choices=num_choices;
+        }
+    }
+    
+    // move v to the end of the uncolored vertices, so that the others are the first num_left-1
+    const int v=uncolored_verts[best];
+    std::swap(uncolored_verts[best],uncolored_verts[num_left-1]);
+    const bool is_leaf=extension_leaf[v-npv];
+    const BIT_MASK v_mask=((BIT_MASK)1)<<v;
+    unsigned int choices=is_leaf ? S.domain[v] : S.domain[v]&real_colors;
+    BIT_MASK culprits=S.reason[v];  // the colors removed from the domain of v, and then why each color of v fails
+    const int *first=extension_constraint_list.data()+extension_constraint_start[v-npv];
+    const int *last =extension_constraint_list.data()+extension_constraint_start[v-npv+1];
+    for (const int *k=first; k<last; k++)
+    {
+        S.uncolored[*k]--;
+        S.uncolored_xor[*k]^=v;
+    }
+    const int *c=S.c.data();
+    const size_t trail_size=S.trail.size();
+    while (choices)
+    {
+        const int color=31-__builtin_clz(choices);  // the largest remaining color, as in the chronological search
+        choices^=1u<<color;
+        S.c[v]=color;
+        
+        bool dead_end=false;
+        for (const int *k=first; (k<last) && !dead_end; k++)
+            if (S.uncolored[*k]==1)  // the constraint has one uncolored vertex left, so we narrow its domain
+            {
+                const cExtensionConstraint &C=extension_constraints[*k];
+                const int w=S.uncolored_xor[*k];
+                int i=0;
+                while (C.vert[i]!=w)
+                    i++;
+                const unsigned int forbidden=S.domain[w]&C.rule[i].forbidden(c);
+                if (forbidden)
+                {
+                    S.trail.push_back(std::make_pair(w,S.domain[w]));
+                    S.reason_trail.push_back(S.reason[w]);
+                    S.domain[w]^=forbidden;
+                    SEARCH_STAT(S.stats.rejected[(C.num_verts==2) ? 0 : (C.num_verts==4) ? 1 : 2]+=__builtin_popcount(forbidden);)
+                    for (int j=0; j<C.num_verts; j++)  // the other vertices of the constraint are colored
+                        if (j!=i)
+                            S.reason[w]|=((BIT_MASK)1)<<C.vert[j];
+                    dead_end=(S.domain[w]==0);
+                    if (dead_end)
+                        culprits|=S.reason[w]&~v_mask;
+                }
+            }
+        
+        bool backjump=false;
+        if (!dead_end)
+        {
+            counters.num_nodes++;
+            SEARCH_STAT(S.stats.nodes[v]++;)
+            if (extend_remaining(S,counters,num_left-1,is_leaf ? max_color : std::max(max_color,color),conflict))
+                return true;
+            // If the color of v is not to blame, then the other colors of v fail in the same way,
+            // so we jump back to the last vertex whose color is to blame.
+            backjump=((conflict&v_mask)==0);
+            culprits|=conflict&~v_mask;
+        }
+        
+        while (S.trail.size()>trail_size)
+        {
+            S.domain[S.trail.back().first]=S.trail.back().second;
+            S.reason[S.trail.back().first]=S.reason_trail.back();
+            S.trail.pop_back();
+            S.reason_trail.pop_back();
+        }
+        if (backjump)
+        {
+            SEARCH_STAT(S.stats.backjumps++;)
+            culprits=conflict;
+            break;
+        }
+    }
+    for (const int *k=first; k<last; k++)
+    {
+        S.uncolored[*k]++;
+        S.uncolored_xor[*k]^=v;
+    }
+    std::swap(uncolored_verts[best],uncolored_verts[num_left-1]);
+    SEARCH_STAT(S.stats.backtracks[v]++;)
+    conflict=culprits;
+    return false;
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::start_search(cSearchState<BIT_MASK> &S,const int *prefix,int root)
+    // fix the colors of vertices 0..root to prefix, and set up the search of the subtree below them
+{
+    for (int i=num_colors; i>0; i--)
+        S.color_mask[i]=0;
+    for (int i=0; i<=root; i++)
+    {
+        S.c[i]=prefix[i];
+        S.color_mask[prefix[i]]|=((BIT_MASK)1)<<i;
+        S.max_color[i]=(i>0) ? S.max_color[i-1] : 0;
+        if (((((BIT_MASK)1)<<i)&tendril_leaves)==0)
+            S.max_color[i]=std::max(S.max_color[i],prefix[i]);
+    }
+    S.root=root;
+    S.cur=root+1;
+    S.cur_mask=((BIT_MASK)1)<<S.cur;
+    if (use_extension_cache && S.cache.outcome.empty())  // the cache persists between the subtrees searched from S
+    {
+        S.cache.init(options.cache_entries/std::max(options.num_threads,1),((int)boundary_verts.size()+11)/12);
+        S.cache_key.resize(S.cache.key_words);
+    }
+    if (use_extension_solver && (options.nogood_entries>0) && (S.nogoods.max_entries==0))  // as do the nogoods
+        S.nogoods.init(options.nogood_entries);
+    S.cache_pending=false;
+    set_first_color(S);
+    compute_forbidden_colors(S);
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::resume_search(cSearchState<BIT_MASK> &S,const cWorkerCheckpoint &W)
+    // restore the search in progress of a worker thread from a checkpoint;
+    // the color masks and the forbidden colors are recomputed from the colors
+{
+    start_search(S,W.c.data(),W.cur-1);
+    S.root=W.root;
+    for (int v=W.root+1; v<W.cur; v++)  // the vertices that we may backtrack to
+    {
+        S.cur=v;
+        S.cur_mask=((BIT_MASK)1)<<v;
+        compute_forbidden_colors(S);
+    }
+    S.cur=W.cur;
+    S.cur_mask=((BIT_MASK)1)<<W.cur;
+    S.c[W.cur]=W.c[W.cur];
+}
+
+
+long long int steady_seconds()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+template<typename BIT_MASK>
+bool cProblemInstance<BIT_MASK>::checkpoint_due()
+    // whether the worker threads should stop at the next consistent point to write a checkpoint
+{
+    if (options.checkpoint_file.empty())
+        return false;
+    if (checkpoint_requested || stop_signal_received)
+        return true;
+    if (steady_seconds()>=next_checkpoint_time)
+    {
+        checkpoint_requested=true;
+        return true;
+    }
+    return false;
+}
+
+
+template<typename BIT_MASK>
+bool cProblemInstance<BIT_MASK>::take_checkpoint(const cSearchState<BIT_MASK> *S,int worker)
+    // Records the state of the worker, which is S, or nullptr if it is between tasks,
+    // and waits until all active workers have done the same and the checkpoint is written.
+    // Returns false if the search should stop.
+{
+    std::unique_lock<std::mutex> guard(checkpoint_lock);
+    cWorkerCheckpoint &W=worker_checkpoints[worker];
+    if (S)
+    {
+        W.root=S->root;
+        W.cur=S->cur;
+        W.c.assign(S->c.begin(),S->c.begin()+S->cur+1);
+    }
+    else
+        W.root=-1;
+    
+    arrived_workers++;
+    if (arrived_workers==active_workers)
+        write_checkpoint();
+    else
+    {
+        long long int generation=checkpoint_generation;
+        checkpoint_written.wait(guard,[&]{ return checkpoint_generation!=generation; });
+    }
+    return !stopped_for_checkpoint;
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::worker_finished(int worker)
+    // the worker will not take part in any more checkpoints
+{
+    std::lock_guard<std::mutex> guard(checkpoint_lock);
+    worker_checkpoints[worker].root=-1;
+    active_workers--;
+    if ((arrived_workers>0) && (arrived_workers==active_workers))  // the others are waiting for us
+        write_checkpoint();
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::write_checkpoint()
+    // Called with checkpoint_lock held while all active workers are waiting.
+    // We write to a temporary file and rename it, so that the checkpoint file is always complete.
+    // The failures found so far are saved with the counters; if the job was killed after this checkpoint,
+    // the resumed search prints again the failures it had found since, but counts and keeps each of them once.
+{
+    cSearchCounters counters=base_counters;
+    for (size_t i=0; i<worker_counters.size(); i++)
+    {
+        counters.merge(worker_counters[i]);
+        worker_checkpoints[i].next=queues ? (*queues)[i].next : 0;
+        worker_checkpoints[i].end =queues ? (*queues)[i].end  : 0;
+    }
+    
+    std::string temp_file=options.checkpoint_file+".tmp";
+    FILE *f=fopen(temp_file.c_str(),"wb");
+    bool written=(f!=nullptr);
+    if (f)
+    {
+        const char magic[8]="SPCKPT4";
+        int header[7]={n,num_colors,num_precolored_verts,parallel_job_number,parallel_num_jobs,parallel_depth,
+                       (int)worker_checkpoints.size()};
+        fwrite(magic,1,8,f);
+        fwrite(header,sizeof(int),7,f);
+        fwrite(&counters.num_precolorings,sizeof(counters.num_precolorings),1,f);
+        fwrite(&counters.num_nodes,sizeof(counters.num_nodes),1,f);
+        fwrite(&counters.num_failures,sizeof(counters.num_failures),1,f);
+        fwrite(&counters.parallel_count,sizeof(counters.parallel_count),1,f);
+        fwrite(&counters.cache_lookups,sizeof(counters.cache_lookups),1,f);
+        fwrite(&counters.cache_hits,sizeof(counters.cache_hits),1,f);
+        fwrite(&counters.nogoods_learned,sizeof(counters.nogoods_learned),1,f);
+        fwrite(&counters.nogood_hits,sizeof(counters.nogood_hits),1,f);
+        int num_failing=(int)failing_precolorings.size()/num_precolored_verts;
+        fwrite(&num_failing,sizeof(num_failing),1,f);
+        for (int color : failing_precolorings)
+            fputc(color,f);
+        for (const cWorkerCheckpoint &W : worker_checkpoints)
+        {
+            fwrite(&W.next,sizeof(W.next),1,f);
+            fwrite(&W.end,sizeof(W.end),1,f);
+            fwrite(&W.root,sizeof(W.root),1,f);
+            fwrite(&W.cur,sizeof(W.cur),1,f);
+            if (W.root>=0)
+                for (int i=0; i<=W.cur; i++)
+                    fputc(W.c[i],f);
+        }
+        written=(fflush(f)==0) && (fsync(fileno(f))==0);
+        written=(fclose(f)==0) && written;
+        written=written && (rename(temp_file.c_str(),options.checkpoint_file.c_str())==0);
+    }
+    
+    stopped_for_checkpoint=stop_signal_received;
+    {
+        std::lock_guard<std::mutex> output_guard(output_lock);
+        if (written)
+            printf("Wrote checkpoint %s, num_precolorings=%llu, num_failures=%d, parallel_count=%lld\n",
+                   options.checkpoint_file.c_str(),counters.num_precolorings,counters.num_failures,counters.parallel_count);
+        else
+        {
+            printf("ERROR: could not write checkpoint %s\n",options.checkpoint_file.c_str());
+            stopped_for_checkpoint=false;  // keep going rather than lose the work
+        }
+        fflush(stdout);
+    }
+    
+    arrived_workers=0;
+    checkpoint_requested=false;
+    next_checkpoint_time=steady_seconds()+options.checkpoint_interval;
+    checkpoint_generation++;
+    checkpoint_written.notify_all();
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::read_checkpoint()
+    // restores base_counters, failing_precolorings and worker_checkpoints from options.checkpoint_file
+{
+    FILE *f=fopen(options.checkpoint_file.c_str(),"rb");
+    if (!f)
+    {
+        printf("ERROR: could not open checkpoint %s\n",options.checkpoint_file.c_str());
+        exit(99);
+    }
+    char magic[8];
+    int header[7];
+    int expected[7]={n,num_colors,num_precolored_verts,parallel_job_number,parallel_num_jobs,parallel_depth,
+                     (int)worker_checkpoints.size()};
+    bool valid=(fread(magic,1,8,f)==8) && (std::string(magic,7)=="SPCKPT4") &&
+               (fread(header,sizeof(int),7,f)==7) && std::equal(header,header+7,expected);
+    cSearchCounters &counters=base_counters;
+    valid=valid &&
+          (fread(&counters.num_precolorings,sizeof(counters.num_precolorings),1,f)==1) &&
+          (fread(&counters.num_nodes,sizeof(counters.num_nodes),1,f)==1) &&
+          (fread(&counters.num_failures,sizeof(counters.num_failures),1,f)==1) &&
+          (fread(&counters.parallel_count,sizeof(counters.parallel_count),1,f)==1) &&
+          (fread(&counters.cache_lookups,sizeof(counters.cache_lookups),1,f)==1) &&
+          (fread(&counters.cache_hits,sizeof(counters.cache_hits),1,f)==1) &&
+          (fread(&counters.nogoods_learned,sizeof(counters.nogoods_learned),1,f)==1) &&
+          (fread(&counters.nogood_hits,sizeof(counters.nogood_hits),1,f)==1);
+    int num_failing=-1;
+    valid=valid && (fread(&num_failing,sizeof(num_failing),1,f)==1) && (num_failing>=0) && (num_failing<=counters.num_failures);
+    if (valid)
+    {
+        failing_precolorings.resize((size_t)num_failing*num_precolored_verts);
+        for (int &color : failing_precolorings)
+            color=fgetc(f);
+        valid=failing_precolorings.empty() || (failing_precolorings.back()>=0);  // not EOF
+    }
+    for (size_t i=0; valid && i<worker_checkpoints.size(); i++)
+    {
+        cWorkerCheckpoint &W=worker_checkpoints[i];
+        valid=(fread(&W.next,sizeof(W.next),1,f)==1) &&
+              (fread(&W.end,sizeof(W.end),1,f)==1) &&
+              (fread(&W.root,sizeof(W.root),1,f)==1) &&
+              (fread(&W.cur,sizeof(W.cur),1,f)==1) &&
+              (W.root<W.cur) && (W.cur<n);
+        if (valid && W.root>=0)
+        {
+            W.c.resize(W.cur+1);
+            for (int j=0; j<=W.cur; j++)
+                W.c[j]=fgetc(f);
+            valid=(W.c[W.cur]>=0);  // not EOF
+        }
+    }
+    fclose(f);
+    if (!valid)
+    {
+        printf("ERROR: checkpoint %s does not match this instance, job, depth and number of threads\n",
+               options.checkpoint_file.c_str());
+        exit(99);
+    }
+    printf("Resuming from checkpoint %s, num_precolorings=%llu, num_failures=%d, parallel_count=%lld\n",
+           options.checkpoint_file.c_str(),counters.num_precolorings,counters.num_failures,counters.parallel_count);
+}
+
+
+template<typename BIT_MASK>
+bool cProblemInstance<BIT_MASK>::search(cSearchState<BIT_MASK> &S,cSearchCounters &counters,std::vector<uint8_t> *frontier)
+    // Runs the backtracking search from S until we backtrack to S.root.
+    // If frontier is given, the colorings of vertices 0..parallel_depth that pass the parallel_job_number filter
+    // are appended to it instead of being searched.
+    // Returns false if the search was stopped because there were too many failures.
+{
+    std::vector<int> &c=S.c;
+    std::vector<int> &prev_c=S.prev_c;
+    std::vector<int> &max_color=S.max_color;
+    std::vector<BIT_MASK> &color_mask=S.color_mask;
+    const std::vector<unsigned int> &forbidden_colors=S.forbidden_colors;
+    int cur=S.cur;  // current vertex
+    BIT_MASK cur_mask=S.cur_mask;  // a single bit set in the position corresponding to the current vertex, v
+    const int root=S.root;
+#if STAR_PRECOLOR_SPECIALIZED
+    constexpr int npv=specialized_num_precolored_verts;  // constants of the instance, in a specialized build
+    constexpr int num_search_colors=specialized_num_colors;
+#else
+    const int npv=num_precolored_verts;
+    const int num_search_colors=num_colors;
+#endif
+    
+    const BIT_MASK mask_extended_vertices=first_bits_mask<BIT_MASK>(npv-1);
+            // a mask to clear the colors on vertices beyond the precolored vertices
+            // also clear bit num_verts_to_precolor-1
+    const BIT_MASK mask_first_n_bits=first_bits_mask<BIT_MASK>(n);
+            // mask with first n positions set; used to test with cur_mask when cur<n
+    const BIT_MASK mask_parallel_depth=first_bits_mask<BIT_MASK>(parallel_depth+1)^first_bits_mask<BIT_MASK>(parallel_depth);
+            // mask with bit set at parallel_depth; used to test when cur==parallel_depth
+            // (this is 0 if parallel_depth is beyond the bits of BIT_MASK)
+    
+    bool backtrack;
+    unsigned int allowed_colors;
+    unsigned int steps=0;  // iterations of the main loop, to check for checkpoints occasionally
+    SEARCH_STAT(cSearchTimer search_timer(S.stats.search_seconds);)
+    
+    while (true)  // main loop
+    {
+        // we have just arrived at cur, and we need to find the *next* valid color for cur
+        
+        if (((++steps&0xffff)==0) && (frontier==nullptr) && checkpoint_due())
+        {
+            // the state here is consistent, so we can save it
+            S.cur=cur;
+            S.cur_mask=cur_mask;
+            if (!take_checkpoint(&S,S.worker))
+                return false;
+        }
+        /*
+        printf("\nStarting main loop, cur=%2d c=%d\n",cur,c[cur]);
+        if (cur <= num_precolored_verts-12)
+        {
+            printf("cur=%2d num_precolorings=%19llu",cur,counters.num_precolorings);
+            for (int i=0; i<=cur; i++)
+                printf(" %d:%d",i,c[i]);
+            printf("\n");
+        }
+        //*/
+        
+        
+        // The colors of the predecessors of cur are fixed, so we computed the colors they forbid on cur
+        // when we arrived at cur.  The next valid color is the largest allowed color that is at most c[cur].
+        // Note that we might arrive here with c[cur] already 0, in which case we want to backtrack.
+        // We will use the colors 1..num_colors, and we count colors downward.
+        allowed_colors=((2u<<c[cur])-1) & ~forbidden_colors[cur] & ~1u;  // bit k is set if color k is allowed; there is no color 0
+        if (allowed_colors)
+        {
+            c[cur]=31-__builtin_clz(allowed_colors);  // the largest allowed color
+            backtrack=false;
+        }
+        else
+            backtrack=true;
+        
+        
+        //printf("testing whether we should backtrack or not, cur=%d, backtrack=%d\n",cur,(int)backtrack);
+        
+        if (backtrack)
+        {
+            // no more left colors left for cur, so backtrack
+            SEARCH_STAT(S.stats.backtracks[cur]++;)
+            cur--;
+            cur_mask>>=1;
+            
+            if (cur==npv-1)
+                // we have backtracked to the last precolored vertex, so we have failed to extend this precoloring
+            {
+                SEARCH_STAT(S.stats.end_extension(counters.num_nodes);)
+                if (S.cache_pending)
+                {
+                    S.cache.insert(S.cache_key.data(),false);
+                    S.cache_pending=false;
+                }
+                counters.num_failures++; // add one to the number of failures
+                if (!estimating)  // the estimate only reports how many failures its probes found
+                {
+                    int failures_so_far=++total_failures;  // across all worker threads
+                    std::lock_guard<std::mutex> guard(output_lock);
+                    failing_precolorings.insert(failing_precolorings.end(),c.begin(),c.begin()+npv);
+                    if (!options.quiet)  // in batch mode, the result record gives the number of failures
                     {
-                        backtrack=false;
-                        break;  // out of while loop for finding next color
+                        printf("We found a failure! Current number of failures is: %2d\n", failures_so_far);  // print how many failures have been found currently
+                        printf("cur=%2d ",cur);
+                        for (int i=0; i<npv; i++)
+                            printf(" %d:%d",i,c[i]);
+                        printf("\n");
                     }
+                    if (failures_so_far>=max_failures)
+                        return false;  // stop when number of failures is over 100
+                }
+            }
+            
+            if (cur==root)  // we have backtracked to the root of the search and are done
+                break;
+            
+            color_mask[c[cur]]^=cur_mask;  // clear the color mask
+            c[cur]--;  // advance the color on cur
+            continue;  // main while loop
+        }
+        else  // good color found, not backtracking, so we advance to the next vertex
+        {
+            // parallelization code
+            if (cur_mask & mask_parallel_depth)  // cur==parallel_depth
+            {
+                counters.parallel_count++;
+                //printf("cur=%2d parallel_depth=%2d parallel_count=%5d parallel_num_jobs=%5d parallel_job_number=%5d\n",
+                //    cur,parallel_depth,counters.parallel_count,parallel_num_jobs,parallel_job_number);
+                if ((counters.parallel_count%parallel_num_jobs)!=parallel_job_number)
+                {
+                    // we do not continue examining this subtree of the search tree
+                    //printf("parallel NOT continuing!\n");
+                    c[cur]--;  // advance the color on cur
+                    continue;  // main while loop
+                }
+                if (frontier)
+                {
+                    // the subtree is searched later by a worker thread, starting from this coloring
+                    frontier->insert(frontier->end(),c.begin(),c.begin()+cur+1);
+                    c[cur]--;  // advance the color on cur
+                    continue;  // main while loop
                 }
+                if (!options.quiet)
+                    printf("Proceeding past parallel_depth=%d, parallel_count=%lld, num_precolorings=%llu\n",parallel_depth,counters.parallel_count,counters.num_precolorings);
             }
             
-            // this color was no good, so we advance to the next color and start the loop again.
-            c[cur]--;
+            // set the color_mask
+            color_mask[c[cur]]|=cur_mask;
+            counters.num_nodes++;
+            SEARCH_STAT(S.stats.nodes[cur]++;)
+            if (cur_mask&tendril_leaves)
+                max_color[cur]=max_color[cur-1];
+            else
+                max_color[cur]=std::max(max_color[cur-1],c[cur]);
+            
+            // move to next vertex
+            cur++;
+            cur_mask<<=1;
+            
+            int known_outcome=-1;  // 1 if we know that the precoloring extends, 0 if we know that it is a failure
+            SEARCH_STAT(if (cur==npv) S.stats.begin_extension(counters.num_nodes);)
+            if ((cur==npv) && use_extension_cache && (cur<n))
+                // we are about to extend a precoloring, but we may already know the outcome
+                known_outcome=lookup_extension_cache(S,counters);
+            if ((cur==npv) && (known_outcome<0) && S.nogoods.contains(c.data(),canonical_boundary))
+            {
+                counters.nogood_hits++;
+                known_outcome=0;  // the precoloring contains a coloring that we already know does not extend
+            }
+            if ((cur==npv) && use_extension_solver && (known_outcome<0))
+                known_outcome=extend_precoloring(S,counters) ? 1 : 0;  // the solver decides the extension in one call
             
-        }  // while loop finding next color
+            if (((cur_mask & mask_first_n_bits)==0) ||  // cur>=n; we have colored all of the vertices
+                (known_outcome==1))  // or we know that the precoloring extends
+            {
+                //printf("Hooray!  This precoloring extends! cur=%d\n",cur);
+                SEARCH_STAT(S.stats.end_extension(counters.num_nodes);)
+                
+                if (S.cache_pending)
+                {
+                    S.cache.insert(S.cache_key.data(),true);
+                    S.cache_pending=false;
+                }
+                counters.num_precolorings++;  // note this only counts precolorings that extend
+                if (((counters.num_precolorings&0xffffff)==0) && !options.quiet)  //((num_precolorings&0xffffffff)==0)  // 32 bits set, roughly 1 billion
+                {
+                    std::lock_guard<std::mutex> guard(output_lock);
+                    printf("num_precolorings=%15llu",counters.num_precolorings);
+                    bool marker_placed=false;
+                    for (int i=0; i<npv; i++)
+                    {
+                        if ((!marker_placed) && (c[i]!=prev_c[i]))
+                        {
+                            printf("+");  // indicates the least vertex whose color has changed since the last output
+                            marker_placed=true;
+                        }
+                        else
+                            printf(" ");
+                        printf("%d:%d",i,c[i]);
+                        prev_c[i]=c[i];
+                    }
+                    printf("\n");
+                }
+                
+                cur=npv-1;  // go back to the last precolored vertex
+                cur_mask=((BIT_MASK)1)<<cur;
+                
+                c[cur]--;  // advance the color on cur
+                
+                // we need to clear the color_masks for the vertices from cur to n, inclusive
+                for (int i=num_search_colors; i>0; i--)
+                    color_mask[i]&=mask_extended_vertices;  // this also clears cur's color
+                
+                if (cur==root)  // the root was the last precolored vertex, so the search is done
+                    break;
+                if (((counters.num_precolorings&0xffff)==0) &&  // only check occasionally, since this is the innermost loop
+                    (total_failures>=max_failures))  // another worker thread has stopped the search
+                    return false;
+            }
+            else if (known_outcome==0)  // we know that the precoloring is a failure
+            {
+                c[cur]=0;  // no colors to try on cur, so we backtrack and record the failure
+            }
+            else
+            {
+                // We will be able to advance cur to the next vertex.
+                // Now we need to set up the first color to try on that vertex.
+                S.cur=cur;
+                S.cur_mask=cur_mask;
+                set_first_color(S);
+                compute_forbidden_colors(S);
+            }
+        }  // advancing to next vertex
         
+    }  // main while loop
+    
+    S.cur=cur;
+    S.cur_mask=cur_mask;
+    return true;
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::search_worker(int worker,std::vector<cWorkStealingQueue> &queues,const std::vector<uint8_t> &frontier,
+                                     cSearchCounters &counters)
+    // Searches the subtrees below the colorings in frontier, taking the task indices from queues[worker],
+    // and stealing from the other queues once that one is empty.
+{
+    cSearchState<BIT_MASK> S(n,num_colors);
+    S.worker=worker;
+    const int prefix_length=parallel_depth+1;
+    std::vector<int> prefix(prefix_length);
+    long long int task;
+    
+    if (worker_checkpoints[worker].root>=0)  // we resume the search that the worker had in progress
+    {
+        resume_search(S,worker_checkpoints[worker]);
+        if (!search(S,counters,nullptr))
+        {
+            SEARCH_STAT(worker_stats[worker]=S.stats;)
+            worker_finished(worker);
+            return;
+        }
+    }
+    
+    while (true)
+    {
+        if (checkpoint_due() && !take_checkpoint(nullptr,worker))
+            break;
         
-        //printf("testing whether we should backtrack or not, cur=%d, backtrack=%d\n",cur,(int)backtrack);
+        if (!queues[worker].pop(task))
+        {
+            // our queue is empty, so we steal half of the remaining tasks of another worker
+            bool stolen=false;
+            for (int i=1; i<options.num_threads && !stolen; i++)
+            {
+                long long int steal_next,steal_end;
+                if (queues[(worker+i)%options.num_threads].steal(steal_next,steal_end))
+                {
+                    std::lock_guard<std::mutex> guard(queues[worker].lock);
+                    queues[worker].next=steal_next;
+                    queues[worker].end =steal_end;
+                    stolen=true;
+                }
+            }
+            if (!stolen)
+                break;  // no tasks are left anywhere
+            continue;
+        }
         
-        if (backtrack)
+        if (total_failures>=max_failures)
+            break;
+        
+        prefix.assign(frontier.begin()+task*prefix_length,frontier.begin()+(task+1)*prefix_length);
+        start_search(S,prefix.data(),parallel_depth);
+        if (!search(S,counters,nullptr))
+            break;
+    }
+    SEARCH_STAT(worker_stats[worker]=S.stats;)
+    worker_finished(worker);
+}
+
+
+#if SEARCH_STATS
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::write_stats_file(const cSearchCounters &counters,const cSearchStats &stats,bool completed)
+    // writes the counters and the statistics of the search to options.stats_file as JSON
+{
+    FILE *f=fopen(options.stats_file.c_str(),"w");
+    if (!f)
+    {
+        printf("ERROR: could not write stats file %s\n",options.stats_file.c_str());
+        return;
+    }
+    fprintf(f,"{\n");
+    fprintf(f,"  \"n\": %d, \"num_colors\": %d, \"num_precolored_verts\": %d,\n",n,num_colors,num_precolored_verts);
+    fprintf(f,"  \"job\": %d, \"num_jobs\": %d, \"parallel_depth\": %d, \"num_threads\": %d,\n",
+            parallel_job_number,parallel_num_jobs,parallel_depth,options.num_threads);
+    fprintf(f,"  \"completed\": %s,\n",completed ? "true" : "false");
+    fprintf(f,"  \"num_precolorings\": %llu, \"num_failures\": %d, \"num_nodes\": %llu, \"parallel_count\": %lld,\n",
+            counters.num_precolorings,counters.num_failures,counters.num_nodes,counters.parallel_count);
+    fprintf(f,"  \"cache_lookups\": %llu, \"cache_hits\": %llu, \"nogoods_learned\": %llu, \"nogood_hits\": %llu,\n",
+            counters.cache_lookups,counters.cache_hits,counters.nogoods_learned,counters.nogood_hits);
+    fprintf(f,"  \"search_seconds\": %.6f, \"precoloring_seconds\": %.6f, \"extension_seconds\": %.6f,\n",
+            stats.search_seconds,stats.search_seconds-stats.extension_seconds,stats.extension_seconds);
+    fprintf(f,"  \"extensions\": %llu, \"backjumps\": %llu,\n",stats.extensions,stats.backjumps);
+    fprintf(f,"  \"rejected_colors\": {\"adjacency\": %llu, \"four_set\": %llu, \"three_set\": %llu},\n",
+            stats.rejected[0],stats.rejected[1],stats.rejected[2]);
+    
+    const std::vector<unsigned long long int> *per_depth[2]={&stats.nodes,&stats.backtracks};
+    const char *per_depth_names[2]={"nodes_per_depth","backtracks_per_depth"};
+    for (int k=0; k<2; k++)
+    {
+        fprintf(f,"  \"%s\": [",per_depth_names[k]);
+        for (size_t v=0; v<per_depth[k]->size(); v++)
+            fprintf(f,"%s%llu",v ? ", " : "",(*per_depth[k])[v]);
+        fprintf(f,"],\n");
+    }
+    int num_buckets=65;
+    while ((num_buckets>1) && (stats.extension_nodes_log2[num_buckets-1]==0))
+        num_buckets--;
+    fprintf(f,"  \"extension_nodes_log2\": [");
+    for (int k=0; k<num_buckets; k++)
+        fprintf(f,"%s%llu",k ? ", " : "",stats.extension_nodes_log2[k]);
+    fprintf(f,"],\n");
+    
+    // only the worker threads, if there were any
+    fprintf(f,"  \"threads\": [");
+    bool first=true;
+    for (size_t i=0; i<worker_stats.size(); i++)
+    {
+        const cSearchStats &W=worker_stats[i];
+        if (W.nodes.empty())
+            continue;
+        unsigned long long int num_nodes=0;
+        for (unsigned long long int count : W.nodes)
+            num_nodes+=count;
+        fprintf(f,"%s\n    {\"worker\": %d, \"nodes\": %llu, \"extensions\": %llu, \"search_seconds\": %.6f, \"extension_seconds\": %.6f}",
+                first ? "" : ",",(int)i,num_nodes,W.extensions,W.search_seconds,W.extension_seconds);
+        first=false;
+    }
+    fprintf(f,"%s]\n",first ? "" : "\n  ");
+    fprintf(f,"}\n");
+    fclose(f);
+}
+#endif
+
+
+template<typename BIT_MASK>
+bool cProblemInstance<BIT_MASK>::verify_precoloring_extension()
+    // should the parallelization parameters be parameters for this function?
+{
+    cSearchState<BIT_MASK> S(n,num_colors);
+    int first_color[1]={1};  // only color to check for vertex 0
+    
+    const int num_workers=std::max(options.num_threads,1);
+    base_counters=cSearchCounters();
+    worker_counters.assign(num_workers,cSearchCounters());
+    worker_checkpoints.assign(num_workers,cWorkerCheckpoint());
+    SEARCH_STAT(worker_stats.assign(num_workers,cSearchStats());)
+    queues=nullptr;
+    checkpoint_requested=false;
+    next_checkpoint_time=steady_seconds()+options.checkpoint_interval;
+    active_workers=num_workers;
+    arrived_workers=0;
+    checkpoint_generation=0;
+    stopped_for_checkpoint=false;
+    if (!options.checkpoint_file.empty())
+        signal(SIGTERM,handle_stop_signal);  // write a checkpoint and stop, rather than lose the search
+    failing_precolorings.clear();
+    if (options.resume)
+        read_checkpoint();
+    total_failures=base_counters.num_failures;
+    
+    bool completed;
+    if ((options.num_threads<=1) && options.work_unit_file.empty())
+    {
+        if (!options.resume)
+        {
+            start_search(S,first_color,0);
+            completed=search(S,worker_counters[0],nullptr);
+        }
+        else if (worker_checkpoints[0].root>=0)
+        {
+            // the search filters the subtrees at parallel_depth with its own parallel_count, so it needs the restored counters
+            std::swap(worker_counters[0],base_counters);
+            resume_search(S,worker_checkpoints[0]);
+            completed=search(S,worker_counters[0],nullptr);
+        }
+        else
+            completed=true;  // the checkpoint was written after the search was done
+    }
+    else
+    {
+        // We first collect the colorings of vertices 0..parallel_depth that this job is responsible for,
+        // or read them from a frontier file, and then split the subtrees below them between the worker threads.
+        // When we resume, the frontier is the same, but the counters and the queues come from the checkpoint.
+        cSearchCounters frontier_counters;
+        std::vector<uint8_t> frontier;
+        if (options.work_unit_file.empty())
+            frontier=collect_frontier(S,frontier_counters);
+        else
+        {
+            cFrontierFile F;
+            frontier=F.read_prefixes(options.work_unit_file,options.work_unit_first,options.work_unit_end);
+            if ((F.n!=n) || (F.num_colors!=num_colors) || (F.num_precolored_verts!=num_precolored_verts) || (F.depth!=parallel_depth))
+            {
+                printf("ERROR: frontier file %s is for n=%d, num_colors=%d, num_precolored_verts=%d, depth=%d\n",
+                       options.work_unit_file.c_str(),F.n,F.num_colors,F.num_precolored_verts,F.depth);
+                exit(99);
+            }
+            frontier_counters.parallel_count=options.work_unit_end-options.work_unit_first;  // the nodes at parallel_depth of this unit
+            printf("Work unit: prefixes %lld..%lld of %s\n",options.work_unit_first,options.work_unit_end-1,options.work_unit_file.c_str());
+        }
+        if (!options.resume)
+            base_counters=frontier_counters;
+        const long long int num_tasks=frontier.size()/(parallel_depth+1);
+        if (!options.quiet)
+            printf("Splitting %lld subtrees below parallel_depth=%d between %d threads\n",num_tasks,parallel_depth,options.num_threads);
+        
+        std::vector<cWorkStealingQueue> worker_queues(options.num_threads);
+        for (int i=0; i<options.num_threads; i++)  // initially each worker gets a contiguous block of the tasks
+        {
+            worker_queues[i].next=options.resume ? worker_checkpoints[i].next : num_tasks*i/options.num_threads;
+            worker_queues[i].end =options.resume ? worker_checkpoints[i].end  : num_tasks*(i+1)/options.num_threads;
+        }
+        queues=&worker_queues;
+        
+        std::vector<std::thread> workers;
+        for (int i=0; i<options.num_threads; i++)
+            workers.emplace_back(&cProblemInstance<BIT_MASK>::search_worker,this,i,
+                                 std::ref(worker_queues),std::cref(frontier),std::ref(worker_counters[i]));
+        for (int i=0; i<options.num_threads; i++)
+            workers[i].join();
+        queues=nullptr;
+        completed=(total_failures<max_failures);
+    }
+    
+    cSearchCounters counters=base_counters;
+    for (int i=0; i<num_workers; i++)
+        counters.merge(worker_counters[i]);
+    result_counters=counters;
+#if SEARCH_STATS
+    if (!options.stats_file.empty())
+    {
+        // the statistics of S are those of the single thread, or of collecting the frontier for the worker threads
+        cSearchStats stats=S.stats;
+        for (int i=0; i<num_workers; i++)
+            stats.merge(worker_stats[i]);
+        write_stats_file(counters,stats,completed && !stopped_for_checkpoint);
+    }
+#endif
+    
+    if (stopped_for_checkpoint)
+    {
+        printf("Stopped after writing checkpoint %s; continue with --resume.\n",options.checkpoint_file.c_str());
+        return false;
+    }
+    if (!options.checkpoint_file.empty())
+        remove(options.checkpoint_file.c_str());  // the search is over, so we will not resume it
+    
+    if (options.quiet)
+        return completed;
+    if (!completed)
+    {
+        printf("Number of failures is over %d, exiting.\n",max_failures);
+        printf("FAIL.  num_precolorings=%19llu\n",counters.num_precolorings);
+        return false;
+    }
+    
+    printf("final parallel_count=%lld\n",counters.parallel_count);
+    if (use_extension_cache)
+        printf("extension cache: lookups=%llu, hits=%llu, hit rate=%.1f%%\n",counters.cache_lookups,counters.cache_hits,
+               counters.cache_lookups ? 100.0*counters.cache_hits/counters.cache_lookups : 0.0);
+    if (counters.nogoods_learned>0)
+        printf("nogoods: learned=%llu, hits=%llu\n",counters.nogoods_learned,counters.nogood_hits);
+    if (counters.num_failures>0)
+        printf("FAIL.  num_precolorings=%19llu, num_failures=%d\n",counters.num_precolorings,counters.num_failures);
+    else
+        printf("Done.  num_precolorings=%19llu\n",counters.num_precolorings);
+    return true;
+}
+
+
+template<typename BIT_MASK>
+bool cProblemInstance<BIT_MASK>::decide_extension(const int *prefix)
+    // Decides with the extension solver whether the precoloring prefix of vertices 0..num_precolored_verts-1 extends,
+    // without the search over the precolorings; prefix must be a valid star coloring of those vertices.
+    // This is for the line graphs of --graph6, which have no tendrils or symmetry pairs, so the solver applies.
+{
+    assert(use_extension_solver);
+    cSearchState<BIT_MASK> S(n,num_colors);
+    cSearchCounters counters;
+    start_search(S,prefix,num_precolored_verts-1);
+    return extend_precoloring(S,counters);
+}
+
+
+template<typename BIT_MASK>
+std::vector<uint8_t> cProblemInstance<BIT_MASK>::collect_frontier(cSearchState<BIT_MASK> &S,cSearchCounters &counters)
+    // the colorings of vertices 0..parallel_depth that this job is responsible for, one after the other,
+    // with a byte for each color, as in frontier files, since there can be very many of them
+{
+    std::vector<uint8_t> frontier;
+    int first_color[1]={1};  // only color to check for vertex 0
+    if (parallel_depth==0)
+        frontier.push_back(1);
+    else
+    {
+        start_search(S,first_color,0);
+        search(S,counters,&frontier);
+    }
+    return frontier;
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::emit_frontier()
+    // Writes the prefixes at parallel_depth to a frontier file, so that jobs can search ranges of them with --work-unit.
+    // With frontier_probes, the cost of each prefix is estimated as the average size of its subtree over random probes.
+{
+    cSearchState<BIT_MASK> S(n,num_colors);
+    cSearchCounters counters;
+    std::vector<uint8_t> frontier=collect_frontier(S,counters);
+    const int prefix_length=parallel_depth+1;
+    const long long int num_prefixes=frontier.size()/prefix_length;
+    std::vector<int> prefix(prefix_length);
+    
+    std::vector<double> costs;
+    double total_cost=0;
+    if (options.frontier_probes>0)
+    {
+        estimating=true;
+        costs.resize(num_prefixes);
+        std::vector<double> weight(num_precolored_verts);
+        std::mt19937_64 random_generator(1);  // fixed seed, so that the costs are repeatable
+        cSearchCounters probe_counters;
+        for (long long int i=0; i<num_prefixes; i++)
+        {
+            double work=0;
+            for (int probe=0; probe<options.frontier_probes; probe++)
+            {
+                prefix.assign(frontier.begin()+i*prefix_length,frontier.begin()+(i+1)*prefix_length);
+                start_search(S,prefix.data(),parallel_depth);
+                double extension_work;
+                bool extends;
+                int depth=random_probe(S,random_generator,weight,extension_work,extends,probe_counters);
+                for (int d=parallel_depth+1; d<=depth; d++)
+                    work+=weight[d];
+                if (depth==num_precolored_verts-1)
+                    work+=weight[depth]*extension_work;
+            }
+            costs[i]=1+work/options.frontier_probes;  // the prefix itself costs something, even if its subtree is empty
+            total_cost+=costs[i];
+        }
+        estimating=false;
+    }
+    
+    cFrontierFile F;
+    F.n=n;
+    F.num_colors=num_colors;
+    F.num_precolored_verts=num_precolored_verts;
+    F.depth=parallel_depth;
+    F.write(options.emit_frontier_file,frontier,costs);
+    printf("Wrote %lld prefixes at parallel_depth=%d to %s\n",num_prefixes,parallel_depth,options.emit_frontier_file.c_str());
+    if (options.frontier_probes>0)
+        printf("est. total cost=%.4g nodes, %d probes per prefix\n",total_cost,options.frontier_probes);
+}
+
+
+template<typename BIT_MASK>
+int cProblemInstance<BIT_MASK>::random_probe(cSearchState<BIT_MASK> &S,std::mt19937_64 &random_generator,std::vector<double> &weight,
+                                             double &extension_work,bool &extends,cSearchCounters &counters)
+    // Continues the search set up in S down one random path, giving each vertex a uniformly random valid color.
+    // weight[d] is the number of nodes at depth d that the path stands for, relative to weight[S.root]=1.
+    // If the path reaches a whole precoloring, we extend it as the search does, which adds to counters;
+    // extension_work is then the number of nodes of the extension, and extends says whether it succeeded.
+    // Returns the deepest vertex colored.
+{
+    const int npv=num_precolored_verts;
+    int depth=S.root;
+    weight[depth]=1;
+    while (S.cur<npv)
+    {
+        const int cur=S.cur;
+        unsigned int allowed_colors=((2u<<S.c[cur])-1) & ~S.forbidden_colors[cur] & ~1u;
+        const int num_choices=__builtin_popcount(allowed_colors);
+        if (num_choices==0)
+            break;  // a dead end
+        for (int k=std::uniform_int_distribution<int>(0,num_choices-1)(random_generator); k>0; k--)
+            allowed_colors&=allowed_colors-1;  // drop the lowest allowed colors, to choose a random one
+        S.c[cur]=__builtin_ctz(allowed_colors);
+        S.color_mask[S.c[cur]]|=S.cur_mask;
+        if (S.cur_mask&tendril_leaves)
+            S.max_color[cur]=S.max_color[cur-1];
+        else
+            S.max_color[cur]=std::max(S.max_color[cur-1],S.c[cur]);
+        weight[cur]=weight[cur-1]*num_choices;
+        depth=cur;
+        
+        S.cur++;
+        S.cur_mask<<=1;
+        if (S.cur<npv)
+        {
+            set_first_color(S);
+            compute_forbidden_colors(S);
+        }
+    }
+    
+    extension_work=0;
+    extends=true;
+    if ((depth==npv-1) && (npv<n))
+    {
+        cSearchCounters extension;
+        if (use_extension_solver)
+        {
+            extends=extend_precoloring(S,extension);
+            extension.num_failures=!extends;
+        }
+        else
+        {
+            start_search(S,S.c.data(),npv-1);
+            search(S,extension,nullptr);
+            extends=(extension.num_failures==0);
+        }
+        extension_work=extension.num_nodes;
+        counters.merge(extension);
+    }
+    return depth;
+}
+
+
+template<typename BIT_MASK>
+void cProblemInstance<BIT_MASK>::estimate_search_tree()
+    // Estimates the size of the search with Knuth's random probes: each probe colors the precolored vertices
+    // with random valid colors, and a node at depth d stands for the product of the numbers of choices above it.
+    // When a probe reaches a whole precoloring, we extend it with the usual search to measure the extension.
+    // From the sizes of the subtrees below the probes, we suggest a parallel_depth at which the subtrees
+    // are numerous enough, for their sizes, that the jobs get about the same work.
+{
+    const long long int num_probes=options.estimate_probes;
+    const int num_jobs_planned=parallel_num_jobs;
+    printf("Estimating the search with %lld random probes\n",num_probes);
+    
+    // the probes do their own splitting, and only the extensions use the search
+    estimating=true;
+    parallel_job_number=0;
+    parallel_num_jobs=1;
+    parallel_depth=num_precolored_verts-1;  // the extensions never advance from this depth
+    options.checkpoint_file.clear();
+    
+    const int npv=num_precolored_verts;
+    std::vector<double> nodes(npv,0.0);  // sum over the probes of the estimated number of nodes at each depth
+    std::vector<double> below(npv,0.0);  // sum over the probes of the estimated work below each node at that depth,
+    std::vector<double> below_squared(npv,0.0);  // and of its square, divided by the number of nodes
+    double extension_nodes=0,extending=0,failing=0;
+    
+    cSearchState<BIT_MASK> S(n,num_colors);
+    cSearchCounters counters;
+    std::vector<double> weight(npv);  // weight[d] is the number of nodes at depth d that the probe stands for
+    std::mt19937_64 random_generator(1);  // fixed seed, so that the estimate is repeatable
+    unsigned long long int probe_nodes=0;
+    auto start_time=std::chrono::steady_clock::now();
+    int first_color[1]={1};  // only color to check for vertex 0
+    
+    for (long long int probe=0; probe<num_probes; probe++)
+    {
+        start_search(S,first_color,0);
+        double extension_work;
+        bool extends;
+        int depth=random_probe(S,random_generator,weight,extension_work,extends,counters);  // the deepest vertex that the probe colored
+        probe_nodes+=depth;
+        if (depth==npv-1)
+        {
+            extension_nodes+=weight[npv-1]*extension_work;
+            (extends ? extending : failing)+=weight[npv-1];
+        }
+        
+        // the work below depth d is the nodes deeper than d, plus the extensions
+        double work=(depth==npv-1) ? weight[npv-1]*extension_work : 0;
+        for (int d=npv-1; d>=0; d--)
+        {
+            if (d<=depth)
+            {
+                nodes[d]+=weight[d];
+                below[d]+=work;
+                below_squared[d]+=work*work/weight[d];
+                work+=weight[d];
+            }
+        }
+    }
+    probe_nodes+=counters.num_nodes;
+    double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start_time).count();
+    
+    extension_nodes/=num_probes;
+    double total_nodes=extension_nodes;
+    for (int d=0; d<npv; d++)
+        total_nodes+=nodes[d]/num_probes;
+    double nodes_per_second=(seconds>0) ? probe_nodes/seconds : 0;
+    double cpu_hours=(nodes_per_second>0) ? total_nodes/nodes_per_second/3600 : 0;
+    
+    const int num_threads=std::max(options.num_threads,1);
+    int num_jobs=num_jobs_planned;
+    if (num_jobs<=1)  // suggest enough jobs of job_hours
+        num_jobs=std::max(1,(int)std::ceil(cpu_hours/(options.job_hours*num_threads)));
+    
+    // With modulo splitting, a job gets about width/num_jobs random subtrees, so its work varies by
+    // about cv/sqrt(width/num_jobs) relative to the average, where cv is the coefficient of variation of the subtree sizes.
+    // We count each thread as a job, which is pessimistic, since the threads share their subtrees.
+    const int num_parts=num_jobs*num_threads;
+    printf("depth  est. nodes (frontier width)  subtrees/thread  subtree size cv  est. imbalance\n");
+    int suggested_depth=-1;
+    double best_imbalance=0;
+    for (int d=0; d<npv; d++)
+    {
+        double width=nodes[d]/num_probes;
+        double mean_below=below[d]/num_probes;
+        double cv=0;
+        if ((width>0) && (mean_below>0))
+            cv=std::sqrt(std::max(0.0,width*(below_squared[d]/num_probes)/(mean_below*mean_below)-1));
+        double imbalance=(width>0) ? cv/std::sqrt(std::max(width/num_parts,1e-300)) : 0;
+        printf("%5d  %27.4g  %15.4g  %15.3f  %13.1f%%\n",d,width,width/num_parts,cv,100*imbalance);
+        // we want the shallowest depth that is balanced, but not a depth without enough subtrees for the jobs
+        if ((d>0) && (d<npv-1) && (width>=num_parts) &&
+            ((suggested_depth<0) || ((best_imbalance>0.1) && (imbalance<best_imbalance))))
+        {
+            suggested_depth=d;
+            best_imbalance=imbalance;
+        }
+    }
+    
+    printf("est. precolorings=%.4g, extending=%.4g, failing=%.4g (the probes found %d failures)\n",
+           nodes[npv-1]/num_probes,extending/num_probes,failing/num_probes,counters.num_failures);
+    printf("est. extension nodes=%.4g, total nodes=%.4g\n",extension_nodes,total_nodes);
+    printf("the probes ran at %.4g nodes/s, so the search takes roughly %.4g CPU hours\n",nodes_per_second,cpu_hours);
+    if (suggested_depth<0)
+        printf("No depth splits the search between %d jobs of %d threads; use fewer jobs.\n",num_jobs,num_threads);
+    else
+        printf("Suggested split: parallel_depth=%d, num_jobs=%d with %d threads, about %.4g subtrees per thread, est. imbalance %.1f%%\n",
+               suggested_depth,num_jobs,num_threads,nodes[suggested_depth]/num_probes/num_parts,100*best_imbalance);
+}
+
+
+int read_num_vertices(std::string file_input)
+    // reads only the n= line of the input file, so that we can choose the width of the bit masks before parsing.
+{
+    if (cInstanceFile::is_instance_file(file_input))
+    {
+        cInstanceFile F;
+        F.map(file_input);
+        return F.n;
+    }
+    std::string line;
+    std::ifstream file_in(file_input);
+    if (file_in.is_open())
+        while (getline(file_in,line))
+            if (line.rfind("n=",0)==0)
+                return std::stoi(line.substr(2));
+    printf("ERROR: no n= line in file %s\n",file_input.c_str());
+    exit(99);
+}
+
+
+template<typename BIT_MASK>
+int run_instance(std::string file_input,
+                 int parallel_job_number,
+                 int parallel_num_jobs,
+                 int parallel_depth,
+                 const cSearchOptions &options)
+{
+    cProblemInstance<BIT_MASK> P(file_input,parallel_job_number,parallel_num_jobs,parallel_depth,options);
+    if (options.estimate_probes>0)
+    {
+        P.estimate_search_tree();
+        return 0;
+    }
+    if (((options.num_threads>1) || !options.emit_frontier_file.empty() || !options.work_unit_file.empty()) &&
+        (parallel_depth>=P.num_precolored_verts))
+    {
+        printf("ERROR: with threads or frontier files, parallel_depth=%d must be less than num_precolored_verts=%d\n",
+               parallel_depth,P.num_precolored_verts);
+        exit(1);
+    }
+    if (!options.emit_frontier_file.empty())
+    {
+        P.emit_frontier();
+        return 0;
+    }
+    if (P.verify_precoloring_extension())
+        return 0;  // success
+    else if (P.stopped_for_checkpoint)
+        return 2;  // run again with --resume
+    else
+        return 1;  // failure
+}
+
+
+template<typename BIT_MASK>
+void convert_instance(const std::string &file_input,const std::string &file_output)
+    // writes the instance in file_input as a binary instance file
+{
+    cSearchOptions options;
+    options.quiet=true;
+    cProblemInstance<BIT_MASK> P(file_input,0,1,0,options);
+    P.write_instance_file(file_output);
+    printf("Wrote instance file %s: n=%d, num_colors=%d, num_precolored_verts=%d, %d four-set and %d three-set blockers\n",
+           file_output.c_str(),P.n,P.num_colors,P.num_precolored_verts,P.blockers.four_start[P.n],P.blockers.three_start[P.n]);
+}
+
+
+template<typename BIT_MASK>
+void codegen_instance(const std::string &file_input,const std::string &file_output)
+    // writes the source file of a build of star_precolor specialized for the instance in file_input
+{
+    cSearchOptions options;
+    options.quiet=true;
+    cProblemInstance<BIT_MASK> P(file_input,0,1,0,options);
+    P.write_specialized_source(file_output,file_input);
+    printf("Wrote specialized source %s: n=%d, num_colors=%d, num_precolored_verts=%d, %d four-set and %d three-set blockers\n",
+           file_output.c_str(),P.n,P.num_colors,P.num_precolored_verts,P.blockers.four_start[P.n],P.blockers.three_start[P.n]);
+}
+
+
+class cBatchEntry
+// one instance of a batch: the positional arguments of a single run
+{
+public:
+    std::string file_input;
+    int parallel_job_number=0;
+    int parallel_num_jobs=1;
+    int parallel_depth=0;
+};
+
+
+template<typename BIT_MASK>
+bool run_batch_instance(int index,const cBatchEntry &E,const cSearchOptions &options,std::mutex &output_lock)
+    // searches one instance of a batch and prints its result record; returns false if the search stopped at max_failures
+{
+    auto start_time=std::chrono::steady_clock::now();
+    cProblemInstance<BIT_MASK> P(E.file_input,E.parallel_job_number,E.parallel_num_jobs,E.parallel_depth,options);
+    bool completed=P.verify_precoloring_extension();
+    double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start_time).count();
+    const cSearchCounters &counters=P.result_counters;
+    
+    std::lock_guard<std::mutex> guard(output_lock);
+    printf("instance=%d file=%s job=%d num_jobs=%d depth=%d result=%s num_precolorings=%llu num_failures=%d parallel_count=%lld nodes=%llu cache_hits=%llu seconds=%.3f\n",
+           index,E.file_input.c_str(),E.parallel_job_number,E.parallel_num_jobs,E.parallel_depth,
+           !completed ? "FAIL_CAPPED" : (counters.num_failures>0) ? "FAIL" : "Done",
+           counters.num_precolorings,counters.num_failures,counters.parallel_count,counters.num_nodes,counters.cache_hits,seconds);
+    fflush(stdout);
+    return completed;
+}
+
+
+bool run_batch_entry(int index,const cBatchEntry &E,int mask_bits,const cSearchOptions &options,std::mutex &output_lock)
+    // chooses the width of the bit masks for the instance, as main does for a single instance
+{
+    int n=read_num_vertices(E.file_input);
+    int bits=(std::max(mask_bits,n)+63)/64*64;
+    switch (bits)
+    {
+        case 64:
+            return run_batch_instance<unsigned long long int>(index,E,options,output_lock);
+        case 128:
+            return run_batch_instance<unsigned __int128>(index,E,options,output_lock);
+        case 192:
+            return run_batch_instance<cWideBitMask<3> >(index,E,options,output_lock);
+        case 256:
+            return run_batch_instance<cWideBitMask<4> >(index,E,options,output_lock);
+        default:
+            printf("ERROR: n=%d in %s is larger than the widest bit masks (256 bits)\n",n,E.file_input.c_str());
+            exit(99);
+    }
+}
+
+
+void batch_worker(const std::vector<cBatchEntry> &entries,std::atomic<int> &next_entry,std::atomic<int> &num_capped,
+                  int mask_bits,const cSearchOptions &options,std::mutex &output_lock)
+{
+    int index;
+    while ((index=next_entry++)<(int)entries.size())
+        if (!run_batch_entry(index,entries[index],mask_bits,options,output_lock))
+            num_capped++;
+}
+
+
+int run_batch(const std::string &list_file,int mask_bits,const cSearchOptions &options)
+    // Runs the instances listed in list_file, one per line as "<file_input> [<job> <num_jobs> <depth>]",
+    // options.num_threads instances at a time, each in a single thread.
+    // Each instance prints one result record when it is done, so the records are in the order of completion.
+{
+    std::vector<cBatchEntry> entries;
+    std::ifstream list_in(list_file);
+    if (!list_in.is_open())
+    {
+        printf("ERROR: could not read batch list %s\n",list_file.c_str());
+        exit(99);
+    }
+    std::string line;
+    while (getline(list_in,line))
+    {
+        if ((line.find_first_not_of(" \t\r")==std::string::npos) || (line[line.find_first_not_of(" \t")]=='#'))
+            continue;  // blank lines and comments
+        char name[4096];
+        cBatchEntry E;
+        int fields=sscanf(line.c_str(),"%4095s %d %d %d",name,&E.parallel_job_number,&E.parallel_num_jobs,&E.parallel_depth);
+        if ((fields!=1) && (fields!=4))
         {
-            // no more left colors left for cur, so backtrack
-            cur--;
-            cur_mask>>=1;
-            
-            if (cur==num_precolored_verts-1)
-                // we have backtracked to the last precolored vertex, so we have failed to extend this precoloring
-            {
-                num_failures++; // add one to the number of failures
-                printf("We found a failure! Current number of failures is: %2d\n", num_failures);  // print how many failures have been found currently
-                printf("cur=%2d ",cur);
-                for (int i=0; i<num_precolored_verts; i++)
-                    printf(" %d:%d",i,c[i]);
-                printf("\n");
-                if (num_failures>=100)
-                {
-                    printf("Number of failures is over %d, exiting.\n",num_failures);
-                    printf("FAIL.  num_precolorings=%19llu\n",num_precolorings);
-                    return false;  // stop when number of failures is over 100
-                }
-            }
-            
-            if (cur==0)  // we have backtracked to the first vertex and are done
-                break;
-            
-            color_mask[c[cur]]^=cur_mask;  // clear the color mask
-            c[cur]--;  // advance the color on cur
-            continue;  // main while loop
+            printf("ERROR: batch line \"%s\" is not <file_input> [<job> <num_jobs> <depth>]\n",line.c_str());
+            exit(99);
         }
-        else  // good color found, not backtracking, so we advance to the next vertex
+        E.file_input=name;
+        entries.push_back(E);
+    }
+    
+    cSearchOptions instance_options=options;
+    instance_options.num_threads=1;
+    instance_options.quiet=true;
+    const int num_threads=std::max(1,std::min(options.num_threads,(int)entries.size()));
+    printf("Batch of %d instances from %s, %d at a time\n",(int)entries.size(),list_file.c_str(),num_threads);
+    fflush(stdout);
+    
+    std::atomic<int> next_entry{0};
+    std::atomic<int> num_capped{0};
+    std::mutex output_lock;
+    std::vector<std::thread> workers;
+    for (int i=0; i<num_threads; i++)
+        workers.emplace_back(batch_worker,std::cref(entries),std::ref(next_entry),std::ref(num_capped),
+                             mask_bits,std::cref(instance_options),std::ref(output_lock));
+    for (int i=0; i<num_threads; i++)
+        workers[i].join();
+    return (num_capped>0) ? 1 : 0;
+}
+
+
+bool decode_graph6(const std::string &line,int &n,std::vector<std::pair<int,int> > &edges)
+    // Reads a graph in the graph6 format of nauty, as geng writes them; returns false if line is not one.
+    // The bits of the upper triangle of the adjacency matrix are in column order, 6 to a character, the first bit most significant.
+{
+    size_t pos=(line.rfind(">>graph6<<",0)==0) ? 10 : 0;
+    size_t end=line.size();
+    while ((end>pos) && ((line[end-1]=='\r') || (line[end-1]==' ')))
+        end--;
+    if ((pos>=end) || (line[pos]<63) || (line[pos]>126))
+        return false;
+    if (line[pos]<126)
+        n=line[pos++]-63;
+    else
+    {
+        if ((pos+3>=end) || (line[pos+1]==126))
+            return false;  // more than 258047 vertices
+        n=0;
+        for (int i=1; i<=3; i++)
+            n=(n<<6)|(line[pos+i]-63);
+        pos+=4;
+    }
+    edges.clear();
+    int value=0;  // 6-bit value
+    int bits_left_in_value=0;
+    for (int j=1; j<n; j++)
+        for (int i=0; i<j; i++)
         {
-            // parallelization code
-            if (cur_mask & mask_parallel_depth)  // cur==parallel_depth
+            if (bits_left_in_value==0)
             {
-                parallel_count++;
-                //printf("cur=%2d parallel_depth=%2d parallel_count=%5d parallel_num_jobs=%5d parallel_job_number=%5d\n",
-                //    cur,parallel_depth,parallel_count,parallel_num_jobs,parallel_job_number);
-                if ((parallel_count%parallel_num_jobs)!=parallel_job_number)
-                {
-                    // we do not continue examining this subtree of the search tree
-                    //printf("parallel NOT continuing!\n");
-                    c[cur]--;  // advance the color on cur
-                    continue;  // main while loop
-                }
-                printf("Proceeding past parallel_depth=%d, parallel_count=%d, num_precolorings=%llu\n",parallel_depth,parallel_count,num_precolorings);
+                if ((pos>=end) || (line[pos]<63) || (line[pos]>126))
+                    return false;
+                value=line[pos++]-63;
+                bits_left_in_value=6;
             }
-            
-            // set the color_mask
-            color_mask[c[cur]]|=cur_mask;
-            
-            // move to next vertex
-            cur++;
-            cur_mask<<=1;
-            
-            
-            if ((cur_mask & mask_first_n_bits)==0)  // cur>=n; we have colored all of the vertices
+            bits_left_in_value--;
+            if ((value>>bits_left_in_value)&1)
+                edges.push_back(std::make_pair(i,j));
+        }
+    return pos==end;
+}
+
+
+bool is_nonminimal(int n,const std::vector<std::pair<int,int> > &edges)
+    // whether some vertex of degree 2 has both neighbors of degree 2, which star_chromatic_index7.py skips
+{
+    std::vector<int> degree(n,0);
+    for (const std::pair<int,int> &e : edges)
+    {
+        degree[e.first]++;
+        degree[e.second]++;
+    }
+    std::vector<int> degree_two_neighbors(n,0);
+    for (const std::pair<int,int> &e : edges)
+    {
+        degree_two_neighbors[e.first] +=(degree[e.second]==2);
+        degree_two_neighbors[e.second]+=(degree[e.first]==2);
+    }
+    for (int v=0; v<n; v++)
+        if ((degree[v]==2) && (degree_two_neighbors[v]==2))
+            return true;
+    return false;
+}
+
+
+cGraphInstance line_graph_instance(const std::vector<std::pair<int,int> > &edges,int num_colors)
+    // The line graph, with only vertex 0 precolored, so the single precoloring extends if and only if
+    // the line graph is star num_colors-colorable.
+    // Vertex 0 is an edge of largest degree in the line graph, and the others are in breadth-first order from it,
+    // so that each vertex has colored neighbors when the chronological search reaches it.
+{
+    const int m=edges.size();
+    std::vector<std::vector<int> > neighbors(m);
+    for (int f=0; f<m; f++)
+        for (int e=0; e<f; e++)
+            if ((edges[e].first==edges[f].first) || (edges[e].first==edges[f].second) ||
+                (edges[e].second==edges[f].first) || (edges[e].second==edges[f].second))
             {
-                //printf("Hooray!  This precoloring extends! cur=%d\n",cur);
-                
-                num_precolorings++;  // note this only counts precolorings that extend
-                if ((num_precolorings&0xffffff)==0)  //((num_precolorings&0xffffffff)==0)  // 32 bits set, roughly 1 billion
-                {
-                    printf("num_precolorings=%15llu",num_precolorings);
-                    bool marker_placed=false;
-                    for (int i=0; i<num_precolored_verts; i++)
-                    {
-                        if ((!marker_placed) && (c[i]!=prev_c[i]))
-                        {
-                            printf("+");  // indicates the least vertex whose color has changed since the last output
-                            marker_placed=true;
-                        }
-                        else
-                            printf(" ");
-                        printf("%d:%d",i,c[i]);
-                        prev_c[i]=c[i];
-                    }
-                    printf("\n");
-                }
-                
-                cur=num_precolored_verts-1;  // go back to the last precolored vertex
-                cur_mask=((BIT_MASK)1)<<cur;
-                
-                c[cur]--;  // advance the color on cur
-                
-                // we need to clear the color_masks for the vertices from cur to n, inclusive
-                for (int i=num_colors; i>0; i--)
-                    color_mask[i]&=mask_extended_vertices;  // this also clears cur's color
+                neighbors[e].push_back(f);
+                neighbors[f].push_back(e);
             }
-            else
-            {
-                // We will be able to advance cur to the next vertex.
-                // Now we need to set up the first color to try on that vertex.
-                
-                // put the first color to try on the new cur
-                if (cur_mask&tendril_leaves)  // cur is a tendril leaf
-                {
-                    c[cur]=2;  // only two colors (2 and 1) for tendril leaves
-                    //printf("cur=%d is a tendril leaf, only using 2 colors\n",cur);
-                }
-                else if (cur_mask&symmetry_vertices)  // cur is in a symmetry pair
+    
+    std::vector<int> order;  // order[i] is the edge that becomes vertex i
+    std::vector<int> vertex(m,-1);  // the inverse of order
+    while ((int)order.size()<m)  // once for each component
+    {
+        int root=-1;
+        for (int e=0; e<m; e++)
+            if ((vertex[e]<0) && ((root<0) || (neighbors[e].size()>neighbors[root].size())))
+                root=e;
+        vertex[root]=order.size();
+        order.push_back(root);
+        for (size_t i=vertex[root]; i<order.size(); i++)
+            for (int f : neighbors[order[i]])
+                if (vertex[f]<0)
                 {
-                    //printf("cur=%d is a symmetry pair of %d, so using fewer colors\n",cur,SymmetryPair[cur]);
-                    if ((SymmetryPair[cur]<num_colors) &&
-                        (c[SymmetryPair[cur]]==SymmetryPair[cur]+1))
-                        //FIXME: this is probably not the best way to do this, but we probably need to calculate the largest used color at each step.
-                        c[cur]=num_colors;  // just set to maximum
-                            // complicated, since there might be 4 vertices in a symmetry "pair"
-                    else
-                        c[cur]=c[SymmetryPair[cur]]-1;  // the assumption is that the vertices in the symmetry pair are adjacent, or at least should not be the same.
+                    vertex[f]=order.size();
+                    order.push_back(f);
                 }
-                else if (cur<num_colors)  // for vertex cur (which is 0-indexed), only use colors 1..cur+1.
-                    c[cur]=cur+1;
-                else
-                    c[cur]=num_colors;  // for other vertices, use colors 1..num_colors.
-            }
-        }  // advancing to next vertex
+    }
+    
+    cGraphInstance L;
+    L.n=m;
+    L.num_colors=num_colors;
+    L.num_precolored_verts=1;
+    L.is_recolor.assign(L.n,0);
+    L.is_extend.assign(L.n,1);
+    L.is_extend[0]=0;
+    for (int e=0; e<m; e++)
+        for (int f : neighbors[e])
+            if (e<f)
+                L.edges.push_back(std::make_pair(vertex[e],vertex[f]));
+    return L;
+}
+
+
+template<typename BIT_MASK>
+bool is_star_colorable(const cGraphInstance &L,const cSearchOptions &options)
+{
+    cProblemInstance<BIT_MASK> P(L,0,1,0,options);
+    const int first_color[1]={1};
+    return P.decide_extension(first_color);
+}
+
+
+bool is_star_colorable(const cGraphInstance &L,const cSearchOptions &options)
+    // chooses the width of the bit masks for L, as main does for an instance file
+{
+    if (L.n<=1)
+        return true;
+    switch ((L.n+63)/64*64)
+    {
+        case 64:
+            return is_star_colorable<unsigned long long int>(L,options);
+        case 128:
+            return is_star_colorable<unsigned __int128>(L,options);
+        case 192:
+            return is_star_colorable<cWideBitMask<3> >(L,options);
+        default:
+            return is_star_colorable<cWideBitMask<4> >(L,options);
+    }
+}
+
+
+class cGraph6Totals
+// the counts of a run over graph6 input, shared by the worker threads
+{
+public:
+    std::atomic<long long int> num_graphs{0};
+    std::atomic<long long int> num_nonminimal{0};
+    std::atomic<long long int> num_over_5{0};  // line graphs that are not star 5-colorable
+    std::atomic<long long int> num_over_6{0};  // and not star 6-colorable either
+};
+
+
+void graph6_worker(std::mutex &input_lock,long long int &next_count,std::mutex &output_lock,cGraph6Totals &totals,
+                   const cSearchOptions &options)
+    // takes the next line of stdin until there are none, so that the input is streamed
+{
+    std::string line;
+    std::vector<std::pair<int,int> > edges;
+    int n;
+    while (true)
+    {
+        long long int count;
+        {
+            std::lock_guard<std::mutex> guard(input_lock);
+            do
+                if (!std::getline(std::cin,line))
+                    return;
+            while (line.find_first_not_of(" \t\r")==std::string::npos);
+            count=next_count++;
+        }
+        if (!decode_graph6(line,n,edges))
+        {
+            std::lock_guard<std::mutex> guard(output_lock);
+            printf("ERROR: line %lld of the input is not a graph6 string: %s\n",count+1,line.c_str());
+            exit(99);
+        }
+        if (edges.size()>256)
+        {
+            std::lock_guard<std::mutex> guard(output_lock);
+            printf("ERROR: graph %lld has %d edges, which is more than the widest bit masks hold (256 bits)\n",count,(int)edges.size());
+            exit(99);
+        }
+        totals.num_graphs++;
+        if (is_nonminimal(n,edges))
+        {
+            totals.num_nonminimal++;
+            continue;
+        }
         
-    }  // main while loop
+        if (is_star_colorable(line_graph_instance(edges,5),options))
+            continue;
+        const bool over_6=!is_star_colorable(line_graph_instance(edges,6),options);
+        totals.num_over_5++;
+        totals.num_over_6+=over_6;
+        
+        // the lines of star_chromatic_index7.py
+        std::lock_guard<std::mutex> guard(output_lock);
+        printf(">5: n=%d count=%lld\n",n,count);
+        if (over_6)
+            printf(">6: n=%d count=%lld COUNTEREXAMPLE\n",n,count);
+        printf("GRAPH: %s\n",line.c_str());
+        fflush(stdout);
+    }
+}
+
+
+int run_graph6(const cSearchOptions &options)
+    // Reads graphs in graph6 format from stdin, as from geng -C -d2 -D3, and decides whether their line graphs
+    // are star 5-colorable, and if not, whether they are star 6-colorable, with options.num_threads graphs at a time.
+    // We print only the graphs that need more than 5 colors, with their count, the index of their line in the input.
+    // As star_chromatic_index7.py does, we skip the graphs with a vertex of degree 2 whose neighbors both have degree 2.
+    // Returns 1 if some graph needs more than 6 colors.
+{
+    cSearchOptions instance_options=options;
+    instance_options.num_threads=1;
+    instance_options.quiet=true;
+    instance_options.cache_entries=0;  // each search has the single precoloring of vertex 0,
+    instance_options.nogood_entries=0;  // so there is nothing to reuse
+    const int num_threads=std::max(1,options.num_threads);
+    printf("Reading graph6 strings from stdin, %d at a time\n",num_threads);
+    fflush(stdout);
     
-    printf("final parallel_count=%lld\n",parallel_count);
-    if (num_failures>0)
-        printf("FAIL.  num_precolorings=%19llu, num_failures=%d\n",num_precolorings,num_failures);
-    else
-        printf("Done.  num_precolorings=%19llu\n",num_precolorings);
-    return true;
+    std::mutex input_lock,output_lock;
+    long long int next_count=0;
+    cGraph6Totals totals;
+    std::vector<std::thread> workers;
+    for (int i=0; i<num_threads; i++)
+        workers.emplace_back(graph6_worker,std::ref(input_lock),std::ref(next_count),std::ref(output_lock),std::ref(totals),
+                             std::cref(instance_options));
+    for (int i=0; i<num_threads; i++)
+        workers[i].join();
+    printf("Done with %lld graphs: %lld nonminimal, %lld need more than 5 colors, %lld need more than 6 colors\n",
+           (long long int)totals.num_graphs,(long long int)totals.num_nonminimal,(long long int)totals.num_over_5,
+           (long long int)totals.num_over_6);
+    return (totals.num_over_6>0) ? 1 : 0;
+}
+
+
+#if STAR_PRECOLOR_LIBRARY
+
+template<typename BIT_MASK>
+int run_graph_instance(const cGraphInstance &G,int parallel_job_number,int parallel_num_jobs,int parallel_depth,
+                       const cSearchOptions &options,unsigned long long int *counts,int *failing_colors)
+{
+    cProblemInstance<BIT_MASK> P(G,parallel_job_number,parallel_num_jobs,parallel_depth,options);
+    bool completed=P.verify_precoloring_extension();
+    const cSearchCounters &counters=P.result_counters;
+    counts[0]=counters.num_precolorings;
+    counts[1]=counters.num_failures;
+    counts[2]=counters.num_nodes;
+    counts[3]=counters.parallel_count;
+    // with threads, a few more failures than max_failures may be found before the workers stop
+    const size_t num_ints=std::min(P.failing_precolorings.size(),(size_t)P.max_failures*G.num_precolored_verts);
+    std::copy(P.failing_precolorings.begin(),P.failing_precolorings.begin()+num_ints,failing_colors);
+    return completed ? 0 : 1;
+}
+
+
+extern "C" int star_precolor_max_failures()
+{
+    return cProblemInstance<unsigned long long int>::max_failures;
+}
+
+
+extern "C" int star_precolor_extend(int n,const int *edges,int num_edges,int num_colors,int num_precolored_verts,
+                                    const int *recolor_verts,int num_recolor_verts,const int *extend_verts,int num_extend_verts,
+                                    int parallel_job_number,int parallel_num_jobs,int parallel_depth,int num_threads,
+                                    unsigned long long int *counts,int *failing_colors)
+    // Searches the precolorings of vertices 0..num_precolored_verts-1 of the graph on vertices 0..n-1 with the edges
+    // edges[2*i],edges[2*i+1], and their extensions, with the arguments of check_precoloring_extension.
+    // counts gets num_precolorings (those that extend), num_failures, the number of nodes and parallel_count,
+    // and failing_colors, with room for star_precolor_max_failures() of them, gets the colors 1..num_colors
+    // of vertices 0..num_precolored_verts-1 of each failure.
+    // Returns 0 if the search is done, 1 if it stopped at max_failures, and -1 if the arguments are not valid.
+{
+    if ((n<2) || (n>256) || (num_colors<1) || (num_colors>30) || (num_precolored_verts<1) || (num_precolored_verts>n) ||
+        (num_edges<0) || (num_recolor_verts<0) || (num_extend_verts<0) ||
+        (parallel_num_jobs<1) || (parallel_job_number<0) || (parallel_job_number>=parallel_num_jobs) || (parallel_depth<0) ||
+        (num_threads<1) || ((num_threads>1) && (parallel_depth>=num_precolored_verts)))
+        return -1;
+    cGraphInstance G;
+    G.n=n;
+    G.num_colors=num_colors;
+    G.num_precolored_verts=num_precolored_verts;
+    G.is_recolor.assign(n,0);
+    G.is_extend.assign(n,0);
+    for (int i=0; i<num_edges; i++)
+    {
+        if ((edges[2*i]<0) || (edges[2*i]>=n) || (edges[2*i+1]<0) || (edges[2*i+1]>=n))
+            return -1;
+        G.edges.push_back(std::make_pair(edges[2*i],edges[2*i+1]));
+    }
+    for (int i=0; i<num_recolor_verts; i++)
+    {
+        if ((recolor_verts[i]<0) || (recolor_verts[i]>=n))
+            return -1;
+        G.is_recolor[recolor_verts[i]]=1;
+    }
+    for (int i=0; i<num_extend_verts; i++)
+    {
+        if ((extend_verts[i]<0) || (extend_verts[i]>=n))
+            return -1;
+        G.is_extend[extend_verts[i]]=1;
+    }
+    
+    cSearchOptions options;
+    options.num_threads=num_threads;
+    options.quiet=true;
+    switch ((n+63)/64*64)
+    {
+        case 64:
+            return run_graph_instance<unsigned long long int>(G,parallel_job_number,parallel_num_jobs,parallel_depth,options,counts,failing_colors);
+        case 128:
+            return run_graph_instance<unsigned __int128>(G,parallel_job_number,parallel_num_jobs,parallel_depth,options,counts,failing_colors);
+        case 192:
+            return run_graph_instance<cWideBitMask<3> >(G,parallel_job_number,parallel_num_jobs,parallel_depth,options,counts,failing_colors);
+        default:
+            return run_graph_instance<cWideBitMask<4> >(G,parallel_job_number,parallel_num_jobs,parallel_depth,options,counts,failing_colors);
+    }
 }
 
+#else
 
 int main(int argc, char *argv[])
 {
-    if (argc<5)
+    // options start with "--" and may appear anywhere; the remaining arguments are positional.
+    cSearchOptions options;
+    int mask_bits=0;  // 0 means to use the narrowest bit masks that hold n bits
+    std::string batch_file;  // list of instances to run in one process
+    std::string convert_file_input,convert_file_output;  // text instance to write as a binary instance file
+    bool graph6=false;  // decide the star colorability of the line graphs of graph6 strings from stdin
+    std::string codegen_file_input,codegen_file_output;  // instance to write a specialized source file for
+    std::vector<std::string> args;
+    for (int i=1; i<argc; i++)
+    {
+        std::string arg(argv[i]);
+        if ((arg=="--threads") && (i+1<argc))
+            options.num_threads=std::stoi(argv[++i]);
+        else if ((arg=="--cache-entries") && (i+1<argc))
+            options.cache_entries=std::stoll(argv[++i]);
+        else if ((arg=="--nogoods") && (i+1<argc))
+            options.nogood_entries=std::stoi(argv[++i]);
+        else if ((arg=="--checkpoint") && (i+1<argc))
+            options.checkpoint_file=argv[++i];
+        else if ((arg=="--checkpoint-interval") && (i+1<argc))
+            options.checkpoint_interval=std::stoi(argv[++i]);
+        else if (arg=="--resume")
+            options.resume=true;
+        else if ((arg=="--estimate") && (i+1<argc))
+            options.estimate_probes=std::stoll(argv[++i]);
+        else if ((arg=="--job-hours") && (i+1<argc))
+            options.job_hours=std::stod(argv[++i]);
+        else if ((arg=="--emit-frontier") && (i+1<argc))
+            options.emit_frontier_file=argv[++i];
+        else if ((arg=="--frontier-probes") && (i+1<argc))
+            options.frontier_probes=std::stoi(argv[++i]);
+        else if ((arg=="--work-unit") && (i+3<argc))
+        {
+            options.work_unit_file=argv[++i];
+            options.work_unit_first=std::stoll(argv[++i]);
+            options.work_unit_end  =std::stoll(argv[++i]);
+        }
+        else if ((arg=="--split-frontier") && (i+2<argc))
+        {
+            // this needs only the frontier file, so we do it right away
+            split_frontier(argv[i+1],std::stoi(argv[i+2]));
+            return 0;
+        }
+        else if (arg=="--chronological-extension")
+            options.extension_solver=false;
+        else if ((arg=="--stats") && (i+1<argc))
+            options.stats_file=argv[++i];
+        else if ((arg=="--mask-bits") && (i+1<argc))
+            mask_bits=std::stoi(argv[++i]);
+        else if ((arg=="--batch") && (i+1<argc))
+            batch_file=argv[++i];
+        else if (arg=="--graph6")
+            graph6=true;
+        else if ((arg=="--codegen") && (i+2<argc))
+        {
+            codegen_file_input=argv[++i];
+            codegen_file_output=argv[++i];
+        }
+        else if ((arg=="--convert-instance") && (i+2<argc))
+        {
+            convert_file_input=argv[++i];
+            convert_file_output=argv[++i];
+        }
+        else
+            args.push_back(arg);
+    }
+    
+    if (!convert_file_input.empty())
     {
-        printf("USAGE: ./star_precolor <file_input> <parallel_job_number> <parallel_num_jobs> <parallel_depth>\n");
+        // the converted file does not depend on the width of the bit masks, so we use the narrowest
+        int n=read_num_vertices(convert_file_input);
+        if (n<=64)
+            convert_instance<unsigned long long int>(convert_file_input,convert_file_output);
+        else if (n<=128)
+            convert_instance<unsigned __int128>(convert_file_input,convert_file_output);
+        else if (n<=192)
+            convert_instance<cWideBitMask<3> >(convert_file_input,convert_file_output);
+        else if (n<=256)
+            convert_instance<cWideBitMask<4> >(convert_file_input,convert_file_output);
+        else
+        {
+            printf("ERROR: n=%d is larger than the widest bit masks (256 bits)\n",n);
+            exit(99);
+        }
+        return 0;
+    }
+    
+    if (!codegen_file_input.empty())
+    {
+        int n=read_num_vertices(codegen_file_input);
+        if (n<=64)
+            codegen_instance<unsigned long long int>(codegen_file_input,codegen_file_output);
+        else if (n<=128)
+            codegen_instance<unsigned __int128>(codegen_file_input,codegen_file_output);
+        else if (n<=192)
+            codegen_instance<cWideBitMask<3> >(codegen_file_input,codegen_file_output);
+        else if (n<=256)
+            codegen_instance<cWideBitMask<4> >(codegen_file_input,codegen_file_output);
+        else
+        {
+            printf("ERROR: n=%d is larger than the widest bit masks (256 bits)\n",n);
+            exit(99);
+        }
+        return 0;
+    }
+    
+    if (!batch_file.empty())
+    {
+        if (!options.checkpoint_file.empty() || (options.estimate_probes>0) ||
+            !options.emit_frontier_file.empty() || !options.work_unit_file.empty() || !options.stats_file.empty())
+        {
+            printf("ERROR: --batch runs whole instances, without checkpoints, estimates, frontier files or stats files\n");
+            exit(1);
+        }
+        return run_batch(batch_file,mask_bits,options);
+    }
+    
+    if (graph6)
+        return run_graph6(options);
+    
+    if (args.size()<4)
+    {
+        printf("USAGE: ./star_precolor [options] <file_input> <parallel_job_number> <parallel_num_jobs> <parallel_depth>\n"
+               "       ./star_precolor [--threads N] [--mask-bits BITS] --batch <list_file>\n"
+               "       ./star_precolor [--threads N] --graph6 < <graph6_file>\n"
+               "       ./star_precolor --convert-instance <text_file> <instance_file>\n"
+               "       ./star_precolor --codegen <file_input> <source_file>  (see make specialized)\n"
+               "       ./star_precolor --split-frontier <frontier_file> <num_tasks>\n"
+               "options: --threads N, --cache-entries N, --nogoods N, --mask-bits 64|128|192|256, --chronological-extension,\n"
+               "         --checkpoint FILE [--checkpoint-interval SECONDS] [--resume],\n"
+               "         --estimate PROBES [--job-hours H],\n"
+               "         --emit-frontier FILE [--frontier-probes K], --work-unit FILE FIRST END,\n"
+               "         --stats FILE (when built with SEARCH_STATS, as by make stats)\n");
         exit(1);
     }
     
-    std::string file_input(argv[1]);
-    int parallel_job_number=std::stoi(argv[2]);
-    int parallel_num_jobs  =std::stoi(argv[3]);
-    int parallel_depth     =std::stoi(argv[4]);
+    if (options.resume && options.checkpoint_file.empty())
+    {
+        printf("ERROR: --resume needs --checkpoint FILE\n");
+        exit(1);
+    }
+    if (!options.stats_file.empty() && !SEARCH_STATS)
+    {
+        printf("ERROR: --stats needs star_precolor built with SEARCH_STATS; use make stats\n");
+        exit(1);
+    }
     
-    printf("Reading file %s, job=%d, num_jobs=%d, depth=%d\n",
-           file_input.c_str(),parallel_job_number,parallel_num_jobs,parallel_depth);
+    std::string file_input(args[0]);
+    int parallel_job_number=std::stoi(args[1]);
+    int parallel_num_jobs  =std::stoi(args[2]);
+    int parallel_depth     =std::stoi(args[3]);
     
-    cProblemInstance P(file_input,parallel_job_number,parallel_num_jobs,parallel_depth);
-    if (P.verify_precoloring_extension())
-        return 0;  // success
-    else
-        return 1;  // failure
+    int n=read_num_vertices(file_input);
+    if (mask_bits<n)
+        mask_bits=n;
+    mask_bits=(mask_bits+63)/64*64;  // round up to a whole number of 64-bit words
+    
+    printf("Reading file %s, job=%d, num_jobs=%d, depth=%d, threads=%d, mask_bits=%d\n",
+           file_input.c_str(),parallel_job_number,parallel_num_jobs,parallel_depth,options.num_threads,mask_bits);
+    
+    switch (mask_bits)
+    {
+        case 64:
+            return run_instance<unsigned long long int>(file_input,parallel_job_number,parallel_num_jobs,parallel_depth,options);
+        case 128:
+            return run_instance<unsigned __int128>(file_input,parallel_job_number,parallel_num_jobs,parallel_depth,options);
+        case 192:
+            return run_instance<cWideBitMask<3> >(file_input,parallel_job_number,parallel_num_jobs,parallel_depth,options);
+        case 256:
+            return run_instance<cWideBitMask<4> >(file_input,parallel_job_number,parallel_num_jobs,parallel_depth,options);
+        default:
+            printf("ERROR: n=%d is larger than the widest bit masks (256 bits)\n",n);
+            exit(99);
+    }
 }
+
+#endif
@@ -0,0 +1,414 @@
+// C++ program to write the input file of star_precolor, as the end of prepare.sage does.
+// prepare.sage checks every set of 4 vertices of the line graph H for an induced P4 or C4, which is slow for large H,
+// so it can instead write the reordered H and the roles of its vertices to a file, and let this program find them
+// by following the edges from each vertex.  The instance file is the same, line for line.
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <array>
+
+
+class cPrepareInput
+// The line graph H of prepare.sage after its vertices are reordered, and the roles of its vertices.
+// The file has a title line starting with "> ", which is copied to the instance file, and then the lines
+//   n=..., num_colors=..., num_precolored_verts=...
+//   E=u,v for each edge of H, including the edges at tendril leaves,
+//   R=v for each reducer vertex, X=v for each extend vertex,
+//   L=v for each tendril leaf, TB=a,b,... for each group of tendril branches and TS=a,b for each pair of tendril stems,
+// where the L=, TB= and TS= lines are in the order of prepare.sage's lists.
+{
+public:
+    std::string title;
+    int n=0;
+    int num_colors=0;
+    int num_precolored_verts=0;
+    int num_words=0;  // 64-bit words in a bit mask of the vertices
+    std::vector<uint64_t> adj_mask;  // num_words words for each vertex, with the bits of its neighbors
+    std::vector<char> is_reducer,is_extend,is_leaf,is_branch;
+    std::vector<int> tendril_leaves;
+    std::vector<std::vector<int> > tendril_branches;
+    std::vector<std::vector<int> > tendril_stems;
+
+    bool adjacent(int u,int v) const
+    {
+        return (adj_mask[u*num_words+v/64]>>(v%64))&1;
+    }
+
+    void read(const std::string &file_name);
+};
+
+
+void read_list(const std::string &line,std::vector<int> &list)
+    // appends the comma-separated integers after the '=' of line to list
+{
+    size_t pos=line.find('=')+1;
+    while (pos<line.size())
+    {
+        size_t end=line.find(',',pos);
+        if (end==std::string::npos)
+            end=line.size();
+        list.push_back(std::stoi(line.substr(pos,end-pos)));
+        pos=end+1;
+    }
+}
+
+
+void cPrepareInput::read(const std::string &file_name)
+{
+    std::ifstream file_in(file_name);
+    if (!file_in.is_open())
+    {
+        printf("ERROR: could not read %s\n",file_name.c_str());
+        exit(99);
+    }
+    std::vector<int> edges,reducers,extend_verts;
+    std::string line;
+    while (getline(file_in,line))
+    {
+        if (line.rfind("> ",0)==0)
+            title=line;
+        else if (line.rfind("n=",0)==0)
+            n=std::stoi(line.substr(2));
+        else if (line.rfind("num_colors=",0)==0)
+            num_colors=std::stoi(line.substr(11));
+        else if (line.rfind("num_precolored_verts=",0)==0)
+            num_precolored_verts=std::stoi(line.substr(21));
+        else if (line.rfind("E=",0)==0)
+            read_list(line,edges);
+        else if (line.rfind("R=",0)==0)
+            read_list(line,reducers);
+        else if (line.rfind("X=",0)==0)
+            read_list(line,extend_verts);
+        else if (line.rfind("L=",0)==0)
+            read_list(line,tendril_leaves);
+        else if (line.rfind("TB=",0)==0)
+        {
+            tendril_branches.push_back(std::vector<int>());
+            read_list(line,tendril_branches.back());
+        }
+        else if (line.rfind("TS=",0)==0)
+        {
+            tendril_stems.push_back(std::vector<int>());
+            read_list(line,tendril_stems.back());
+        }
+    }
+
+    if ((n<=0) || (edges.size()%2!=0))
+    {
+        printf("ERROR: %s does not give n, or has an incomplete E= line\n",file_name.c_str());
+        exit(99);
+    }
+    std::vector<int> all_verts(edges);
+    all_verts.insert(all_verts.end(),reducers.begin(),reducers.end());
+    all_verts.insert(all_verts.end(),extend_verts.begin(),extend_verts.end());
+    all_verts.insert(all_verts.end(),tendril_leaves.begin(),tendril_leaves.end());
+    for (const std::vector<int> &group : tendril_branches)
+        all_verts.insert(all_verts.end(),group.begin(),group.end());
+    for (const std::vector<int> &group : tendril_stems)
+        all_verts.insert(all_verts.end(),group.begin(),group.end());
+    for (int v : all_verts)
+        if ((v<0) || (v>=n))
+        {
+            printf("ERROR: vertex %d of %s is not in 0..n-1=%d\n",v,file_name.c_str(),n-1);
+            exit(99);
+        }
+
+    num_words=(n+63)/64;
+    adj_mask.assign(n*num_words,0);
+    for (size_t i=0; i<edges.size(); i+=2)
+    {
+        const int u=edges[i],v=edges[i+1];
+        adj_mask[u*num_words+v/64]|=1ull<<(v%64);
+        adj_mask[v*num_words+u/64]|=1ull<<(u%64);
+    }
+    is_reducer.assign(n,0);
+    is_extend.assign(n,0);
+    is_leaf.assign(n,0);
+    is_branch.assign(n,0);
+    for (int v : reducers)
+        is_reducer[v]=1;
+    for (int v : extend_verts)
+        is_extend[v]=1;
+    for (int v : tendril_leaves)
+        is_leaf[v]=1;
+    for (const std::vector<int> &group : tendril_branches)
+        for (int v : group)
+            is_branch[v]=1;
+}
+
+
+class cBlockerWriter
+// Finds the induced P4s and C4s of H and writes their B=, T= and U= lines in the order of prepare.sage,
+// which goes through the sets of 4 vertices in lexicographic order.
+// Each induced P4 or C4 has a spanning path, with its least vertex a at an end or next to one,
+// so we find the sets with least vertex a by following the paths of 4 vertices from a through vertices above a.
+{
+public:
+    const cPrepareInput &H;
+    std::vector<std::string> lines;  // lines[a] has the lines of the sets whose least vertex is a
+    int num_four=0,num_leaf_three=0,num_branch_three=0;  // numbers of B=, T= and U= lines
+
+    cBlockerWriter(const cPrepareInput &H) : H(H), lines(H.n) { }
+
+    void find_sets(int a,std::vector<std::array<int,4> > &sets) const;
+    void write_line(const std::array<int,4> &S,std::string &out,int counts[3]) const;
+    void run(int num_threads);
+};
+
+
+void cBlockerWriter::find_sets(int a,std::vector<std::array<int,4> > &sets) const
+    // the connected sets of 4 vertices with least vertex a, sorted
+{
+    // above[v] has the neighbors of v that are greater than a, in increasing order
+    auto above=[&](int v,std::vector<int> &list)
+    {
+        list.clear();
+        for (int w=a/64; w<H.num_words; w++)
+        {
+            uint64_t bits=H.adj_mask[v*H.num_words+w];
+            if (w==a/64)
+                bits&=~((2ull<<(a%64))-1);  // only the vertices greater than a
+            while (bits)
+            {
+                list.push_back(64*w+__builtin_ctzll(bits));
+                bits&=bits-1;
+            }
+        }
+    };
+
+    std::vector<int> from_a,from_y,from_z;
+    sets.clear();
+    above(a,from_a);
+    for (int y : from_a)
+    {
+        above(y,from_y);
+        for (int z : from_y)
+        {
+            // the path a-y-z-w, with a at an end
+            above(z,from_z);
+            for (int w : from_z)
+                if (w!=y)
+                    sets.push_back({{a,y,z,w}});
+            // the path x-a-y-z, with a next to the end x
+            for (int x : from_a)
+                if ((x!=y) && (x!=z))
+                    sets.push_back({{x,a,y,z}});
+        }
+    }
+    for (std::array<int,4> &S : sets)
+        std::sort(S.begin(),S.end());
+    std::sort(sets.begin(),sets.end());
+    sets.erase(std::unique(sets.begin(),sets.end()),sets.end());
+}
+
+
+void cBlockerWriter::write_line(const std::array<int,4> &S,std::string &out,int counts[3]) const
+    // appends the line of S to out if S is an induced P4 or C4, as prepare.sage does
+{
+    bool has_reducer=false,has_extend=false;
+    for (int v : S)
+    {
+        has_reducer=has_reducer || H.is_reducer[v];
+        has_extend =has_extend  || H.is_extend[v];
+    }
+    if (has_reducer && has_extend)
+        return;  // we cannot mix reducer_verts and extend_verts in a P4 or C4
+
+    int degree[4]={0,0,0,0};
+    int num_edges=0;
+    for (int i=0; i<4; i++)
+        for (int j=i+1; j<4; j++)
+            if (H.adjacent(S[i],S[j]))
+            {
+                degree[i]++;
+                degree[j]++;
+                num_edges++;
+            }
+    int num_degree_one=0;
+    for (int i=0; i<4; i++)
+        num_degree_one+=(degree[i]==1);
+    const bool cycle=(num_edges==4) && (degree[0]==2) && (degree[1]==2) && (degree[2]==2) && (degree[3]==2);
+    const bool path=(num_edges==3) && (num_degree_one==2);  // the star K_{1,3} has three
+    if (!cycle && !path)
+        return;
+
+    // N has the neighbors of cur=max(S) in increasing order, as Sage lists them,
+    // and the other end of the path if cur is an end; other is the remaining vertex.
+    const int cur=S[3];
+    std::vector<int> N;
+    for (int i=0; i<3; i++)
+        if (H.adjacent(S[i],cur))
+            N.push_back(S[i]);
+    if (degree[3]==1)
+        for (int i=0; i<3; i++)
+            if (degree[i]==1)
+                N.push_back(S[i]);
+    int other=-1;
+    for (int i=0; i<3; i++)
+        if (std::find(N.begin(),N.end(),S[i])==N.end())
+            other=S[i];
+
+    int num_leaves=0,num_branches=0;
+    int leaf=-1,branch=-1;
+    for (int v : S)
+    {
+        if (H.is_leaf[v])
+        {
+            num_leaves++;
+            leaf=v;
+        }
+        if (H.is_branch[v])
+        {
+            num_branches++;
+            branch=v;
+        }
+    }
+
+    char line[64];
+    if (num_leaves>=2)
+        return;
+    else if ((num_leaves==1) || (num_branches==1))
+    {
+        // a three-set blocker: the leaf, or the leaf of the tendril branch, and the two vertices that must be equal
+        const int v=(num_leaves==1) ? leaf : branch;
+        if (num_leaves==0)
+        {
+            leaf=-1;
+            for (int w=0; (w<H.n) && (leaf<0); w++)
+                if (H.adjacent(v,w) && H.is_leaf[w])
+                    leaf=w;
+            if (leaf<0)
+            {
+                printf("ERROR: tendril branch %d has no tendril leaf\n",v);
+                exit(99);
+            }
+        }
+        std::vector<int> must_be_equal;
+        if (std::find(N.begin(),N.end(),v)!=N.end())
+            must_be_equal={other,cur};
+        else
+            must_be_equal=N;
+        const int max_equal=*std::max_element(must_be_equal.begin(),must_be_equal.end());
+        const int min_equal=*std::min_element(must_be_equal.begin(),must_be_equal.end());
+        snprintf(line,sizeof(line),"%s=%d,%d,%d\n",(num_leaves==1) ? "T" : "U",leaf,max_equal,min_equal);
+        counts[(num_leaves==1) ? 1 : 2]++;
+    }
+    else
+    {
+        snprintf(line,sizeof(line),"B=%d,%d,%d,%d\n",cur,other,N[0],N[1]);
+        counts[0]++;
+    }
+    out+=line;
+}
+
+
+void cBlockerWriter::run(int num_threads)
+    // the worker threads take the least vertices a one at a time
+{
+    std::atomic<int> next_a{0};
+    std::vector<std::array<int,3> > thread_counts(num_threads,std::array<int,3>{{0,0,0}});
+    auto worker=[&](int t)
+    {
+        std::vector<std::array<int,4> > sets;
+        int a;
+        while ((a=next_a++)<H.n)
+        {
+            find_sets(a,sets);
+            for (const std::array<int,4> &S : sets)
+                write_line(S,lines[a],thread_counts[t].data());
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t=0; t<num_threads; t++)
+        workers.emplace_back(worker,t);
+    for (int t=0; t<num_threads; t++)
+        workers[t].join();
+    for (int t=0; t<num_threads; t++)
+    {
+        num_four        +=thread_counts[t][0];
+        num_leaf_three  +=thread_counts[t][1];
+        num_branch_three+=thread_counts[t][2];
+    }
+}
+
+
+std::string graph_string(const cPrepareInput &H)
+    // the G= line, with the edges that are not at tendril leaves, 6 bits to a character, the first bit the least significant
+{
+    const std::string mapping("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz@#");
+    std::string s="G=";
+    int value=0;  // 6-bit value
+    int bit=0;  // where to put the next bit of value
+    for (int j=0; j<H.n; j++)
+        for (int i=0; i<j; i++)
+        {
+            if (!H.is_leaf[i] && !H.is_leaf[j] && H.adjacent(i,j))
+                value|=1<<bit;
+            if (++bit==6)
+            {
+                s+=mapping[value];
+                value=0;
+                bit=0;
+            }
+        }
+    if (bit!=0)  // are there bits remaining in value that were not written?
+        s+=mapping[value];
+    return s;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int num_threads=std::max(1u,std::thread::hardware_concurrency());
+    std::vector<std::string> args;
+    for (int i=1; i<argc; i++)
+    {
+        std::string arg(argv[i]);
+        if ((arg=="--threads") && (i+1<argc))
+            num_threads=std::max(1,std::stoi(argv[++i]));
+        else
+            args.push_back(arg);
+    }
+    if (args.size()!=2)
+    {
+        printf("USAGE: ./star_prepare [--threads N] <prepare_file> <file_output>\n"
+               "       writes the instance file of star_precolor for the graph and roles in prepare_file\n");
+        exit(1);
+    }
+
+    cPrepareInput H;
+    H.read(args[0]);
+    cBlockerWriter W(H);
+    W.run(num_threads);
+
+    FILE *f=fopen(args[1].c_str(),"w");
+    if (!f)
+    {
+        printf("ERROR: could not write %s\n",args[1].c_str());
+        exit(99);
+    }
+    fprintf(f,"%s\n",H.title.c_str());
+    fprintf(f,"n=%d\n",H.n);
+    fprintf(f,"num_colors=%d\n",H.num_colors);
+    fprintf(f,"num_precolored_verts=%d\n",H.num_precolored_verts);
+    fprintf(f,"%s\n",graph_string(H).c_str());
+    for (const std::string &lines : W.lines)
+        fputs(lines.c_str(),f);
+    for (int v : H.tendril_leaves)  // give list of tendril leaves
+        fprintf(f,"L=%d\n",v);
+    for (int k=0; k<2; k++)  // give list of tendril branches+stems, as symmetry pairs
+        for (const std::vector<int> &group : (k==0) ? H.tendril_branches : H.tendril_stems)
+            for (size_t i=0; i+1<group.size(); i++)
+                fprintf(f,"S=%d,%d\n",group[i],group[i+1]);
+    fclose(f);
+
+    printf("Wrote %s: n=%d, %d B= lines, %d T= lines, %d U= lines, %d threads\n",
+           args[1].c_str(),H.n,W.num_four,W.num_leaf_three,W.num_branch_three,num_threads);
+    return 0;
+}
@@ -66,6 +66,9 @@ def is_scn_at_most(G,k):
         return False
 
 
+# The same check without an IP solver, in C++ with several threads:
+#   nauty-geng n -C -d2 -D3 res/mod | src/star_precolor --threads 8 --graph6
+# which prints the same >5:, >6: and GRAPH: lines, with count the index of the graph in the output of geng.
 if __name__=="__main__":
 
     if len(sys.argv)<4: